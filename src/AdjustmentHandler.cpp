@@ -1,6 +1,8 @@
 #include "AdjustmentHandler.h"
 #include "Offsets.h"
 #include "Settings.h"
+#include "Stats.h"
+#include "ThreadPool.h"
 #include "Utils.h"
 
 #include <algorithm>
@@ -14,25 +16,19 @@ using namespace SKSE;
 //-----------------------
 
 //Get Controller Data From an Actor Handle
-std::shared_ptr<AdjustmentHandler::ControllerData> AdjustmentHandler::GetControllerData(ActorHandle Handle) {
-	ReadLocker locker(ControllersLock);
-
+AdjustmentHandler::ControllerData* AdjustmentHandler::GetControllerData(ActorHandle Handle) {
 	if (auto Actor = Handle.get()) {
 		if (auto Controller = Actor->GetCharController()) {
-			if (auto Search = ControllerMap.find(Controller); Search != ControllerMap.end()) {
-				return Search->second;
-			}
+			return GetControllerData(Controller);
 		}
 	}
 	return nullptr;
 }
 
 //Get Controller Data From a Char Controller
-std::shared_ptr<AdjustmentHandler::ControllerData> AdjustmentHandler::GetControllerData(bhkCharacterController* CharController) {
-	ReadLocker locker(ControllersLock);
-
-	if (auto Search = ControllerMap.find(CharController); Search != ControllerMap.end()) {
-		return Search->second;
+AdjustmentHandler::ControllerData* AdjustmentHandler::GetControllerData(bhkCharacterController* CharController) {
+	if (auto Search = ControllerHandles.find(CharController); Search != ControllerHandles.end()) {
+		return Controllers.Get(Search->second);
 	}
 
 	return nullptr;
@@ -42,126 +38,107 @@ std::shared_ptr<AdjustmentHandler::ControllerData> AdjustmentHandler::GetControl
 //	Get Shapes
 //-----------------------
 
-bool AdjustmentHandler::GetShapes(bhkCharacterController* CharController, const hkpConvexVerticesShape*& OutConvexShape, std::vector<hkpCapsuleShape*>& OutColisionShape) {
-	const auto readShape = [&](const auto& self, const RE::hkpShape* a_shape) -> bool {
-		if (a_shape) {
-			switch (a_shape->type) {
-			case RE::hkpShapeType::kCapsule:
-				if (auto capsuleShape = const_cast<RE::hkpCapsuleShape*>(skyrim_cast<const RE::hkpCapsuleShape*>(a_shape))) {
-					OutColisionShape.emplace_back(capsuleShape);
-				}
-				break;
-			case RE::hkpShapeType::kConvexVertices:
-				if (auto convexVerticesShape = const_cast<RE::hkpConvexVerticesShape*>(skyrim_cast<const RE::hkpConvexVerticesShape*>(a_shape))) {
-					assert(a_outCollisionConvexVerticesShape == nullptr);
-					OutConvexShape = convexVerticesShape;
-					return true;
-				}
-				break;
-			case RE::hkpShapeType::kList:
-				if (auto listShape = skyrim_cast<RE::hkpListShape*>(const_cast<RE::hkpShape*>(a_shape))) {
-					for (auto& childInfo : listShape->childInfo) {
-						if (auto child = childInfo.shape) {
-							self(self, child);
-						}
-					}
-				}
-				break;
-			case RE::hkpShapeType::kMOPP:
-				if (auto moppShape = const_cast<RE::hkpMoppBvTreeShape*>(skyrim_cast<const RE::hkpMoppBvTreeShape*>(a_shape))) {
-					RE::hkpShapeBuffer buf{};
-					RE::hkpShapeKey shapeKey = moppShape->child.GetFirstKey();
-					for (int i = 0; i < moppShape->child.GetNumChildShapes(); ++i) {
-						if (auto child = moppShape->child.GetChildShape(shapeKey, buf)) {
-							self(self, child);
-						}
-						shapeKey = moppShape->child.GetNextKey(shapeKey);
-					}
-				}
-				break;
+namespace {
+	struct HavokShapeTraits {
+		using Shape = hkpShape;
+		using Capsule = hkpCapsuleShape;
+		using Convex = hkpConvexVerticesShape;
+		using ChildBuffer = hkpShapeBuffer;
+
+		static ShapeVisitor::Kind TypeOf(const hkpShape* Shape) {
+			switch (Shape->type) {
+				case hkpShapeType::kCapsule:
+					return ShapeVisitor::Kind::kCapsule;
+				case hkpShapeType::kConvexVertices:
+					return ShapeVisitor::Kind::kConvex;
+				case hkpShapeType::kList:
+					return ShapeVisitor::Kind::kList;
+				case hkpShapeType::kMOPP:
+					return ShapeVisitor::Kind::kContainer;
+				default:
+					return ShapeVisitor::Kind::kOther;
 			}
 		}
 
-		return false;
-	};
-
-	if (auto proxyController = skyrim_cast<RE::bhkCharProxyController*>(CharController)) {
-		if (auto charProxy = static_cast<RE::hkpCharacterProxy*>(proxyController->proxy.referencedObject.get())) {
-			readShape(readShape, charProxy->shapePhantom->collidable.shape);
-
-			return OutConvexShape || !OutColisionShape.empty();
+		static hkpCapsuleShape* AsCapsule(const hkpShape* Shape) {
+			return const_cast<hkpCapsuleShape*>(skyrim_cast<const hkpCapsuleShape*>(Shape));
 		}
-	} else if (auto rigidBodyController = skyrim_cast<RE::bhkCharRigidBodyController*>(CharController)) {
-		if (auto rigidBody = static_cast<RE::hkpCharacterRigidBody*>(rigidBodyController->rigidBody.referencedObject.get())) {
-			readShape(readShape, rigidBody->character->collidable.shape);
 
-			return OutConvexShape || !OutColisionShape.empty();
+		static hkpConvexVerticesShape* AsConvex(const hkpShape* Shape) {
+			return const_cast<hkpConvexVerticesShape*>(skyrim_cast<const hkpConvexVerticesShape*>(Shape));
 		}
-	}
-
-	return false;
-}
-
-bool AdjustmentHandler::GetCapsules(bhkCharacterController* CharController, std::vector<hkpCapsuleShape*>& OutCollisionCapsules) {
-
-	const auto ReadShape = [&](const auto& Self, const hkpShape* Shape) {
 
-		if (Shape == nullptr) return;
-
-		switch (Shape->type) {
-			case hkpShapeType::kCapsule:{
-				if (hkpCapsuleShape* CapsuleShape = const_cast<hkpCapsuleShape*>(skyrim_cast< const hkpCapsuleShape*>(Shape))) {
-					OutCollisionCapsules.emplace_back(CapsuleShape);
+		template <class Fn>
+		static void ForEachListChild(const hkpShape* Shape, Fn&& Callback) {
+			if (hkpListShape* ListShape = skyrim_cast<hkpListShape*>(const_cast<hkpShape*>(Shape))) {
+				for (hkpListShape::ChildInfo& ChildInfo : ListShape->childInfo) {
+					if (ChildInfo.shape) Callback(ChildInfo.shape);
 				}
-				break;
 			}
+		}
 
-			case hkpShapeType::kList:{
-				if (hkpListShape* ListShape = skyrim_cast<hkpListShape*>(const_cast<hkpShape*>(Shape))) {
-					for (hkpListShape::ChildInfo& ChildInfo : ListShape->childInfo) {
-						if (auto Child = ChildInfo.shape) {
-							Self(Self, Child);
-						}
+		template <class Fn>
+		static void ForEachContainerChild(const hkpShape* Shape, hkpShapeBuffer& Buffer, Fn&& Callback) {
+			if (hkpMoppBvTreeShape* MOPPShape = const_cast<hkpMoppBvTreeShape*>(skyrim_cast<const hkpMoppBvTreeShape*>(Shape))) {
+				hkpShapeKey ShapeKey = MOPPShape->child.GetFirstKey();
+				for (int i = 0; i < MOPPShape->child.GetNumChildShapes(); ++i) {
+					if (const hkpShape* ChildShape = MOPPShape->child.GetChildShape(ShapeKey, Buffer)) {
+						Callback(ChildShape);
 					}
+					ShapeKey = MOPPShape->child.GetNextKey(ShapeKey);
 				}
-				break;
 			}
+		}
+	};
 
-			case hkpShapeType::kMOPP: {
-				if (hkpMoppBvTreeShape* MOPPShape = const_cast<hkpMoppBvTreeShape*>(skyrim_cast< const hkpMoppBvTreeShape*>(Shape))) {
-					hkpShapeBuffer ShapeBuffer{};
-					hkpShapeKey ShapeKey = MOPPShape->child.GetFirstKey();
-					for (int i = 0; i < MOPPShape->child.GetNumChildShapes(); ++i) {
-						if (auto ChildShape = MOPPShape->child.GetChildShape(ShapeKey, ShapeBuffer)) {
-							Self(Self, ChildShape);
-						}
-						ShapeKey = MOPPShape->child.GetNextKey(ShapeKey);
-					}
-				}
-				break;
+	//Top level shape of the proxy's phantom or the rigid body
+	const hkpShape* GetCollidableShape(bhkCharacterController* CharController) {
+		if (bhkCharProxyController* ProxyController = skyrim_cast<bhkCharProxyController*>(CharController)) {
+			if (hkpCharacterProxy* CharacterProxy = static_cast<hkpCharacterProxy*>(ProxyController->proxy.referencedObject.get())) {
+				return CharacterProxy->shapePhantom->collidable.shape;
 			}
-
-			default:{
-				break;
+		} else if (bhkCharRigidBodyController* RigidBodyController = skyrim_cast<bhkCharRigidBodyController*>(CharController)) {
+			if (hkpCharacterRigidBody* RigidBody = static_cast<hkpCharacterRigidBody*>(RigidBodyController->rigidBody.referencedObject.get())) {
+				return RigidBody->character->collidable.shape;
 			}
 		}
-	};
+		return nullptr;
+	}
 
-	if (bhkCharProxyController* ProxyController = skyrim_cast<bhkCharProxyController*>(CharController)) {
-		if (hkpCharacterProxy* CharacterProxy = static_cast<hkpCharacterProxy*>(ProxyController->proxy.referencedObject.get())) {
-			ReadShape(ReadShape, CharacterProxy->shapePhantom->collidable.shape);
-			return !OutCollisionCapsules.empty();
-		}
+	template <uint8_t What>
+	using ControllerShapes = ShapeVisitor::Result<HavokShapeTraits, What, AdjustmentHandler::MaxControllerCapsules>;
+
+	//Holds a child buffer per level, too big to keep on the stack for every walk
+	thread_local ShapeVisitor::Walker<HavokShapeTraits> ShapeWalker{};
+}
+
+bool AdjustmentHandler::GetShapes(bhkCharacterController* CharController, const hkpConvexVerticesShape*& OutConvexShape, CapsuleList& OutColisionShape) {
+	const hkpShape* Root = GetCollidableShape(CharController);
+	if (!Root) return false;
+
+	ControllerShapes<ShapeVisitor::kCapsules | ShapeVisitor::kConvexShape> Found{};
+	ShapeWalker.Visit(Root, Found);
+
+	if (Found.ConvexShape) OutConvexShape = Found.ConvexShape;
+	for (hkpCapsuleShape* Capsule : Found.Capsules) {
+		OutColisionShape.push_back(Capsule);
 	}
 
-	else if (bhkCharRigidBodyController*  RigidBodyController = skyrim_cast<bhkCharRigidBodyController*>(CharController)) {
-		if (hkpCharacterRigidBody* RigidBody = static_cast<hkpCharacterRigidBody*>(RigidBodyController->rigidBody.referencedObject.get())) {
-			ReadShape(ReadShape, RigidBody->character->collidable.shape);
-			return !OutCollisionCapsules.empty();
-		}
+	return OutConvexShape || !OutColisionShape.empty();
+}
+
+bool AdjustmentHandler::GetCapsules(bhkCharacterController* CharController, CapsuleList& OutCollisionCapsules) {
+	const hkpShape* Root = GetCollidableShape(CharController);
+	if (!Root) return false;
+
+	ControllerShapes<ShapeVisitor::kCapsules> Found{};
+	ShapeWalker.Visit(Root, Found);
+
+	for (hkpCapsuleShape* Capsule : Found.Capsules) {
+		OutCollisionCapsules.push_back(Capsule);
 	}
 
-	return false;
+	return !OutCollisionCapsules.empty();
 }
 
 bool AdjustmentHandler::GetConvexShape(bhkCharacterController* CharController, hkpCharacterProxy*& OutProxy, hkpCharacterRigidBody*& OutRigidBody, hkpListShape*& OutListshape, hkpConvexVerticesShape*& OutConvexShape) {
@@ -185,10 +162,71 @@ bool AdjustmentHandler::GetConvexShape(bhkCharacterController* CharController, h
 	return false;
 }
 
+//Revalidated with a few pointer compares, the tree only gets walked again if any of them changed
+AdjustmentHandler::ControllerData::ShapeLookup& AdjustmentHandler::ControllerData::LookupShapes() {
+	if (Shapes.Valid && CharController) {
+		bool Current = Shapes.Owners[0].get() == CharController->shapes[0].get() && Shapes.Owners[1].get() == CharController->shapes[1].get();
+
+		//The controller's type never changes, so the casts from the first walk hold
+		if (Current && Shapes.Proxy) {
+			Current = static_cast<bhkCharProxyController*>(CharController)->proxy.referencedObject.get() == Shapes.Proxy &&
+			          Shapes.Proxy->shapePhantom->collidable.shape == Shapes.Collidable;
+		} else if (Current && Shapes.RigidBody) {
+			Current = static_cast<bhkCharRigidBodyController*>(CharController)->rigidBody.referencedObject.get() == Shapes.RigidBody &&
+			          Shapes.RigidBody->character->collidable.shape == Shapes.Collidable;
+		}
+
+		if (Current && Shapes.ListShape) {
+			Current = Shapes.ListShape->childInfo[0].shape == Shapes.ConvexShape;
+		}
+
+		if (Current) return Shapes;
+	}
+
+	Stats::Frame.ShapeLookups++;
+
+	Shapes.Owners = {};
+	Shapes.Collidable = nullptr;
+	Shapes.IsRigidBodyController = false;
+	Shapes.Proxy = nullptr;
+	Shapes.RigidBody = nullptr;
+	Shapes.ListShape = nullptr;
+	Shapes.ConvexShape = nullptr;
+	Shapes.Capsules.clear();
+	Shapes.Valid = false;
+
+	if (!CharController) return Shapes;
+
+	Shapes.Owners = { CharController->shapes[0], CharController->shapes[1] };
+	GetConvexShape(CharController, Shapes.Proxy, Shapes.RigidBody, Shapes.ListShape, Shapes.ConvexShape);
+	GetCapsules(CharController, Shapes.Capsules);
+
+	Shapes.IsRigidBodyController = skyrim_cast<bhkCharRigidBodyController*>(CharController) != nullptr;
+	if (Shapes.Proxy) Shapes.Collidable = Shapes.Proxy->shapePhantom->collidable.shape;
+	else if (Shapes.RigidBody) Shapes.Collidable = Shapes.RigidBody->character->collidable.shape;
+
+	Shapes.Valid = Shapes.Proxy || Shapes.RigidBody;
+	return Shapes;
+}
+
 //-----------------------
 //	Init
 //-----------------------
 
+namespace {
+	//The apex if there is one, otherwise the middle of the ring at its height
+	hkVector4 RingCenter(const std::vector<hkVector4>& Verts, int8_t Apex, const uint8_t* Ring, size_t RingSize) {
+		if (Apex != ControllerHull::NoApex) return Verts[Apex];
+
+		hkVector4 Center;
+		for (size_t i = 0; i < RingSize; i++) {
+			Center.quad.m128_f32[2] += Verts[Ring[i]].quad.m128_f32[2];
+		}
+		Center.quad.m128_f32[2] /= static_cast<float>(RingSize);
+		return Center;
+	}
+}
+
 void AdjustmentHandler::ControllerData::Initialize() {
 
 	NiPointer<Actor> NiActor = ActorHandle.get();
@@ -208,7 +246,9 @@ void AdjustmentHandler::ControllerData::Initialize() {
 
 	Sneaking = NiActor->IsSneaking();
 	VActorScale = NiActor->GetScale();
-	ActorScale = Utils::GetScale(NiActor.get());
+	Bones.Refresh(NiActor.get());
+	Pose = Bones.Sample(NiActor.get(), false);
+	ActorScale = Pose.Scale;
 
 	BSWriteLockGuard lock(World->worldLock);
 
@@ -223,6 +263,19 @@ void AdjustmentHandler::ControllerData::Initialize() {
 		NiPoint3 Vertex = Utils::HkVectorToNiPoint(Verteces[0]);
 		Vertex.z = 0.f;
 		OriginalConvexRadius = Vertex.Length();
+
+		OriginalVertsHash = ShapeInternTable::HashVertices(OriginalVerts, OriginalConvexRadius);
+
+		HasLayout = ControllerHull::Resolve(reinterpret_cast<const ControllerHull::Vector*>(OriginalVerts.data()), OriginalVerts.size(), Layout);
+		ColliderRadius = OriginalConvexRadius * ActorScale;
+		if (HasLayout) {
+			OriginalTop = RingCenter(OriginalVerts, Layout.TopApex, Layout.TopRing.data(), Layout.RingSize);
+			OriginalBottom = RingCenter(OriginalVerts, Layout.BottomApex, Layout.BottomRing.data(), Layout.RingSize);
+			CachedColliderHeight = ((OriginalTop * 2.f) * ActorScale) + OriginalBottom;
+		} else {
+			logger::warn("Unknown controller hull layout with {} vertices [0x{:X}], its shape won't be adjusted", OriginalVerts.size(), NiActor->formID);
+		}
+		ConvexWrapper = NiPointer<bhkShape>(ConvexShape->userData);
 	}
 
 	bool* BumperEnabled = reinterpret_cast<bool*>(&CharController->unk320);
@@ -268,7 +321,7 @@ void AdjustmentHandler::ControllerData::SetupProxyCapsule() {
 	if(bhkCharProxyController* ProxyController = skyrim_cast<bhkCharProxyController*>(CharController)){
 
 		//Player does not need a clone
-		std::vector<hkpCapsuleShape*> Capsules{};
+		CapsuleList Capsules{};
 		
 		//Store Original Shape
 		GetCapsules(ProxyController, Capsules);
@@ -286,9 +339,10 @@ void AdjustmentHandler::ControllerData::SetupProxyCapsule() {
 		//Only Required for creatures, I hope whoever implemented creature havok at bethesda got fired.
 		if (RigidBody && IsCreature) {
 			NiPointer Wrapper(RigidBody->character->collidable.shape->userData);
-			if (Wrapper) {
-				//hkpClone = NiPointer(Utils::Clone<hkpShape>((hkpShape*)(Wrapper2.get()), { ActorScale, ActorScale, ActorScale }));
-				auto NewClone = NiPointer(Utils::Clone<bhkShape>(Wrapper.get(), { ActorScale, ActorScale, ActorScale }));
+			//Creatures of the same skeleton and scale share one clone through the cache
+			auto NewClone = Wrapper ? CreatureCloneCache::GetSingleton()->Acquire(Wrapper.get(), ActorScale) : nullptr;
+			if (NewClone) {
+				CreatureSource = Wrapper;
 				RigidBody->character->SetShape(static_cast<hkpShape*>(NewClone->referencedObject.get()));
 		 		CharController->shapes[shapeIdx] -> DecRefCount();
 				CharController->shapes[shapeIdx] = NewClone;
@@ -296,7 +350,7 @@ void AdjustmentHandler::ControllerData::SetupProxyCapsule() {
 		}
 
 		OldActorScale = ActorScale;
-		std::vector<hkpCapsuleShape*> Capsules{};
+		CapsuleList Capsules{};
 		GetCapsules(RigidBodyController, Capsules);
 
 		for (hkpCapsuleShape* Capsule : Capsules) {
@@ -305,150 +359,69 @@ void AdjustmentHandler::ControllerData::SetupProxyCapsule() {
 			OriginalCapsuleB.emplace_back(Capsule->vertexB);
 		}
 	}
+
+	//Published as is until the first capsule rebuild
+	if (!OriginalCapsuleRadius.empty()) {
+		ColliderCapsuleA = OriginalCapsuleA[0];
+		ColliderCapsuleB = OriginalCapsuleB[0];
+		ColliderCapsuleRadius = OriginalCapsuleRadius[0];
+	}
 }
 
 //Player & Followers
-void AdjustmentHandler::ControllerData::AdjustProxyCapsule() {
-	NiPointer<Actor> NiActor = ActorHandle.get();
-	if (!NiActor) return;
-
-	TESObjectCELL* Cell = NiActor->GetParentCell();
-	if (!Cell) return;
-
-	NiPointer<bhkWorld> World = NiPointer(Cell->GetbhkWorld());
-	if (!World) return;
-
-	if (!CharController) return;
-
-	int8_t shapeIdx = 1;
-	if (!CharController->shapes[shapeIdx]) shapeIdx = 0;
-	if (!CharController->shapes[shapeIdx]) return;
-	if (IsCreature) return;
-
-	BSWriteLockGuard lock(World->worldLock);
-
-	//The Player as the ProxyController.
-	if(bhkCharProxyController* ProxyController = skyrim_cast<bhkCharProxyController*>(CharController)){
-
-		std::vector<hkpCapsuleShape*> Capsules{};
-		GetCapsules(ProxyController, Capsules);
-		if (Capsules.empty()) return;
-		if (Capsules.size() != OriginalCapsuleRadius.size()) return;
-		if (Capsules.size() != OriginalCapsuleA.size()) return;
-		if (Capsules.size() != OriginalCapsuleB.size()) return;
-
-		//So This Should Not Work but it does. Theoretically We should be setting the PhantomShape And not its bhkCapsule,
-		//However This just appears to work so we're doing it this way.
-		//Fyi The Bumper does not appear to actually be used. It looks like the convex shape acts as the bumping shape as well.
-		//Eh better safe than sorry.
-		for (size_t i = 0ull; i < Capsules.size(); i++) {
-			//Set Sphere Radius, This In Reality is the Scale.
-			//The 0.8f is arbitrairy, i find the default shape gets stupidly large so just offset its scale a bit.
-			Capsules[i] -> radius = OriginalCapsuleRadius[i] * ActorScale * 0.8f;
-
-			//Get The Ground Offset for VertexB So It does not go through the floor
-			float GroundOffset = Utils::SphereOffset(OriginalCapsuleRadius[i], Capsules[i]->radius);
-			//Set Head, GetQuad Needs a fixes 1.45x offset compares to the ConvexShape, Subtract Original Z Value From Vertex
-			Capsules[i]-> vertexB.quad.m128_f32[2] = OriginalCapsuleB[i].quad.m128_f32[2] + GroundOffset;
-
-			float TargetZ = Utils::GetHeadQuad(NiActor.get(), 1.45f).quad.m128_f32[2] - OriginalCapsuleA[i].quad.m128_f32[2];
-			float BottomZ = Capsules[i]->vertexB.quad.m128_f32[2];	     //The the bottom Vertex We Just Set
-			float RealZ = TargetZ < BottomZ ? BottomZ + 0.01f : TargetZ; //If Target is lower than bottom Get Bottom + 0.01 else get Top;
-
-			//Set The Top Vertex Z-Pos
-			Capsules[i]->vertexA.quad.m128_f32[2] = RealZ;
-
-			//Move The Shape forward Depending On Scale Index 1 is Y Pos
-			Capsules[i] -> vertexA.quad.m128_f32[1] = OriginalCapsuleA[i].quad.m128_f32[1] * ActorScale;
-			Capsules[i] -> vertexB.quad.m128_f32[1] = OriginalCapsuleB[i].quad.m128_f32[1] * ActorScale;
-		}
-
+//Only queues the capsules up, CapsuleBatch does the math for every controller at once
+bool AdjustmentHandler::ControllerData::ComputeProxyCapsule(CapsuleKernel::Batch& Batch) {
+	if (IsCreature) return false;
+	if (OriginalCapsuleRadius.empty()) return false;
+	if (OriginalCapsuleRadius.size() != OriginalCapsuleA.size()) return false;
+	if (OriginalCapsuleRadius.size() != OriginalCapsuleB.size()) return false;
+
+	//So This Should Not Work but it does. Theoretically We should be setting the PhantomShape And not its bhkCapsule,
+	//However This just appears to work so we're doing it this way.
+	//Fyi The Bumper does not appear to actually be used. It looks like the convex shape acts as the bumping shape as well.
+	//Eh better safe than sorry.
+
+	//Set Head, GetQuad Needs a fixed 1.45x offset compared to the ConvexShape (Same as Utils::GetHeadQuad, from the sampled pose)
+	//The top vertex goes to the head, relative to its original z and never below the bottom vertex
+	CapsuleKernel::Params Adjust{};
+	Adjust.Scale = ActorScale;
+	Adjust.HeadZ = PoseHead.quad.m128_f32[2] + ((1.45f * 0.32f) - 1.f);
+	Adjust.ZScale = -1.f;
+	Adjust.ClampToBottom = true;
+
+	Prepared.CapsuleOffset = static_cast<uint32_t>(Batch.Size());
+	Prepared.CapsuleCount = static_cast<uint32_t>(OriginalCapsuleRadius.size());
+	for (size_t i = 0ull; i < OriginalCapsuleRadius.size(); i++) {
+		Batch.Add({ OriginalCapsuleRadius[i], OriginalCapsuleA[i].quad.m128_f32[1], OriginalCapsuleA[i].quad.m128_f32[2], OriginalCapsuleB[i].quad.m128_f32[1], OriginalCapsuleB[i].quad.m128_f32[2] }, Adjust);
 	}
 
-	//NPC's Get the RigidBodyController.
-	else if (bhkCharRigidBodyController* RigidBodyController = skyrim_cast<bhkCharRigidBodyController*>(CharController)) {
-		std::vector<hkpCapsuleShape*> CapsulesNPC{};
-		GetCapsules(RigidBodyController, CapsulesNPC);
-		if (CapsulesNPC.empty()) return;
-		if (CapsulesNPC.size() != OriginalCapsuleRadius.size()) return;
-		if (CapsulesNPC.size() != OriginalCapsuleA.size()) return;
-		if (CapsulesNPC.size() != OriginalCapsuleB.size()) return;
-
-		for (size_t i = 0ull; i < CapsulesNPC.size(); i++) {
-		 	//Set Sphere Radius, This In Reality is the Scale.
-		 	//The 0.8f is arbitrairy, i find the default shape gets stupidly large so just offset its scale a bit.
-		 	CapsulesNPC[i]->radius = OriginalCapsuleRadius[i] * ActorScale * 0.8f;
-	
-		 	//Get The Ground Offset for VertexB So It does not go through the floor
-		 	const float GroundOffset = Utils::SphereOffset(OriginalCapsuleRadius[i], CapsulesNPC[i]->radius);
-		 	//Set Head, GetQuad Needs a fixed 1.45x offset compared to the ConvexShape, Subtract Original Z Value From Vertex
-		 	CapsulesNPC[i]->vertexB.quad.m128_f32[2] = OriginalCapsuleB[i].quad.m128_f32[2] + GroundOffset;
-	
-		 	float TargetZ = Utils::GetHeadQuad(NiActor.get(), 1.45f).quad.m128_f32[2] - OriginalCapsuleA[i].quad.m128_f32[2];
-		 	float BottomZ = CapsulesNPC[i]->vertexB.quad.m128_f32[2];        //The the bottom Vertex We Just Set
-		 	float RealZ = TargetZ < BottomZ ? BottomZ + 0.01f : TargetZ;     //If Target is lower than bottom Get Bottom + 0.01 else get Top;
-	
-		 	//Set The Top Vertex Z-Pos
-		 	CapsulesNPC[i]->vertexA.quad.m128_f32[2] = RealZ;
-	
-		 	//Move The Shape forward Depending On Scale Index 1 is Y Pos
-		 	CapsulesNPC[i]->vertexA.quad.m128_f32[1] = OriginalCapsuleA[i].quad.m128_f32[1] * ActorScale;
-		 	CapsulesNPC[i]->vertexB.quad.m128_f32[1] = OriginalCapsuleB[i].quad.m128_f32[1] * ActorScale;
-		}
-	}
+	Prepared.RigidBodyCapsulesOnly = false;
+	return true;
 }
 
 //NPC's
-void AdjustmentHandler::ControllerData::AdjustProxyCapsuleSimple() {
-	NiPointer<Actor> NiActor = ActorHandle.get();
-	if (!NiActor)return;
-
-	TESObjectCELL* Cell = NiActor->GetParentCell();
-	if (!Cell) return;
-
-	NiPointer<bhkWorld> World = NiPointer(Cell->GetbhkWorld());
-	if (!World) return;
-
-	if (!CharController) return;
-	if (IsCreature) return;
-
-	TESRace* Race = NiActor->GetRace();
-	if (!Race) return;
-
-	Actor* ActorPtr = NiActor.get();
-	if (!ActorPtr) return;
-
-	int8_t shapeIdx = 1;
-	if (!CharController->shapes[shapeIdx]) shapeIdx = 0;
-	if (!CharController->shapes[shapeIdx]) return;
-
-	BSWriteLockGuard lock(World->worldLock);
+bool AdjustmentHandler::ControllerData::ComputeProxyCapsuleSimple(CapsuleKernel::Batch& Batch) {
+	if (IsCreature) return false;
+	if (OriginalCapsuleRadius.empty()) return false;
+	if (OriginalCapsuleRadius.size() != OriginalCapsuleA.size()) return false;
+	if (OriginalCapsuleRadius.size() != OriginalCapsuleB.size()) return false;
+
+	//The top vertex just scales
+	CapsuleKernel::Params Adjust{};
+	Adjust.Scale = ActorScale;
+	Adjust.HeadZ = 0.f;
+	Adjust.ZScale = ActorScale;
+	Adjust.ClampToBottom = false;
+
+	Prepared.CapsuleOffset = static_cast<uint32_t>(Batch.Size());
+	Prepared.CapsuleCount = static_cast<uint32_t>(OriginalCapsuleRadius.size());
+	for (size_t i = 0ull; i < OriginalCapsuleRadius.size(); i++) {
+		Batch.Add({ OriginalCapsuleRadius[i], OriginalCapsuleA[i].quad.m128_f32[1], OriginalCapsuleA[i].quad.m128_f32[2], OriginalCapsuleB[i].quad.m128_f32[1], OriginalCapsuleB[i].quad.m128_f32[2] }, Adjust);
+	}
 
 	//NPC's Get the RigidBodyController.
-	bhkCharRigidBodyController* RigidBodyController = skyrim_cast<bhkCharRigidBodyController*>(CharController);
-	if (!RigidBodyController) return;
-
-	std::vector<hkpCapsuleShape*> CapsulesNPC{};
-	GetCapsules(RigidBodyController, CapsulesNPC);
-	if (CapsulesNPC.empty()) return;
-	if (CapsulesNPC.size() != OriginalCapsuleRadius.size()) return;
-	if (CapsulesNPC.size() != OriginalCapsuleA.size()) return;
-	if (CapsulesNPC.size() != OriginalCapsuleB.size()) return;
-
-	for (size_t i = 0ull; i < CapsulesNPC.size(); i++) {
-		CapsulesNPC[i]->radius = OriginalCapsuleRadius[i] * ActorScale * 0.8f;
-
-		//Get The Ground Offset for VertexB So It does not go through the floor
-		const float GroundOffset = Utils::SphereOffset(OriginalCapsuleRadius[i], CapsulesNPC[i]->radius);
-		CapsulesNPC[i]->vertexB.quad.m128_f32[2] = OriginalCapsuleB[i].quad.m128_f32[2] + GroundOffset;
-
-		//Set The Top Vertex Z-Pos
-		CapsulesNPC[i]->vertexA.quad.m128_f32[2] = OriginalCapsuleA[i].quad.m128_f32[2] * ActorScale;
-
-		//Move The Shape forward Depending On Scale
-		CapsulesNPC[i]->vertexA.quad.m128_f32[1] = OriginalCapsuleA[i].quad.m128_f32[1] * ActorScale;
-		CapsulesNPC[i]->vertexB.quad.m128_f32[1] = OriginalCapsuleB[i].quad.m128_f32[1] * ActorScale;
-	}
+	Prepared.RigidBodyCapsulesOnly = true;
+	return true;
 }
 
 //Creatures, Skip Creatures. Im too dumb to fix them
@@ -636,6 +609,7 @@ void AdjustmentHandler::ControllerData::AdjustProxyCapsuleCreature(){
 
 //Potentially can cause Memory Leaks. Too Bad
 //Creatures need a new clone on every scale change in order to prevent the game scaling similar skeletons together.
+//The clones come from CreatureCloneCache, so a creature going back and forth between scales doesn't leave a clone behind each time.
 void AdjustmentHandler::ControllerData::AdjustProxyCapsuleCreature_Hack(){
 
 	NiPointer<Actor> NiActor = ActorHandle.get();
@@ -669,22 +643,17 @@ void AdjustmentHandler::ControllerData::AdjustProxyCapsuleCreature_Hack(){
 	//Setup NPC's
 	if (bhkCharRigidBodyController* RigidBodyController = skyrim_cast<bhkCharRigidBodyController*>(CharController)) {
 		hkRefPtr RigidBody(static_cast<hkpCharacterRigidBody*>(RigidBodyController->rigidBody.referencedObject.get()));
-		if (RigidBody) {
-			NiPointer Wrapper(RigidBody->character->collidable.shape->userData);
-			float scale_factor = ActorScale / OldActorScale;
+		if (RigidBody && CreatureSource) {
+			//Always cloned from the creature's own shape at the absolute scale, clones of clones never get shared
+			auto NewClone = CreatureCloneCache::GetSingleton()->Acquire(CreatureSource.get(), ActorScale);
 			OldActorScale = ActorScale;
-			if (Wrapper) {
-				auto NewClone = NiPointer(Utils::Clone<bhkShape>(Wrapper.get(), { scale_factor, scale_factor, scale_factor }));
-				//BSReadWriteLock Lock(World->worldLock);
-				//Lock.LockForRead();
-				//Lock.LockForWrite();
-				RigidBody->character->SetShape(static_cast<hkpShape*>(NewClone->referencedObject.get()));
-				//logger::info("WorldOperation Result {}",(int)res);
-				CharController->shapes[shapeIdx]->DecRefCount();
-				CharController->shapes[shapeIdx] = NewClone;
-				//Lock.UnlockForRead();
-				//Lock.UnlockForWrite();
-			}
+
+			//Same quantized scale as the clone it already has
+			if (!NewClone || NewClone.get() == CharController->shapes[shapeIdx].get()) return;
+
+			RigidBody->character->SetShape(static_cast<hkpShape*>(NewClone->referencedObject.get()));
+			//The old shape is a clone the cache holds on to, dropping our reference is enough
+			CharController->shapes[shapeIdx] = NewClone;
 		}
 	}
 }
@@ -1057,330 +1026,1231 @@ void AdjustmentHandler::ControllerData::AdjustProxyCapsuleCreature_Hack(){
 //Player & Followers
 //The math here sucks
 //TODO Fix Math
-void AdjustmentHandler::ControllerData::AdjustConvexShape() {
-
-	NiPointer<Actor> NiActor = ActorHandle.get();
-	if (!NiActor) return;
-
-	Actor* ActorPtr = NiActor.get();
-	if (!ActorPtr) return;
-
-	TESObjectCELL* Cell = NiActor->GetParentCell();
-	if (!Cell) return;
-
-	NiPointer<bhkWorld> World = NiPointer(Cell->GetbhkWorld());
-	if (!World) return;
+//Only works on the pose sampled on the main thread, this runs on the worker threads
+bool AdjustmentHandler::ControllerData::ComputeConvexShape() {
+	if (OriginalVerts.empty()) return false;
 
 	//const float SwimmingMult = CharacterState == hkpCharacterStateType::kSwimming ? Settings::fSwimmingControllerShapeRadiusMultiplier : 1.f;
 
-	hkpListShape* ListShape;
-	hkpCharacterProxy* CharProxy;
-	hkpConvexVerticesShape* ConvexShape;
-	hkpCharacterRigidBody* CharRigidBody;
-
-	BSWriteLockGuard lock(World->worldLock);
-	if (!GetConvexShape(CharController, CharProxy, CharRigidBody, ListShape, ConvexShape)) return;
-
-	std::vector<hkVector4> NewVerts = OriginalVerts;
+	std::vector<hkVector4>& NewVerts = Prepared.ConvexVerts;
+	NewVerts.assign(OriginalVerts.begin(), OriginalVerts.end());
 
-	if (OriginalVerts.size() == 18) {
-		hkVector4 OrigTop = OriginalVerts[9];
-		hkVector4 OrigBottom = OriginalVerts[8];
-		hkVector4 NewTop = OrigTop * Utils::GetBoneQuad(ActorPtr, "NPC Head [Head]", false,true);
+	if (HasLayout) {
+		hkVector4 OrigTop = OriginalTop;
+		hkVector4 OrigBottom = OriginalBottom;
+		hkVector4 NewTop = OrigTop * PoseHead;
 		hkVector4 Correction;
 
-		CachedColliderHeight = ((OrigTop * 2.f) * ActorScale) + OrigBottom;
+		Prepared.ColliderHeight = ((OrigTop * 2.f) * ActorScale) + OrigBottom;
 
 		//For Some Reason There is a linear Offset, Probably because i dont take worldscale into account
 		Correction.quad.m128_f32[2] = (ActorScale * 0.32f) - 1.f;
 
+		const float FloorZ = OrigBottom.quad.m128_f32[2];
+
 		// Move the top vert
-		NewVerts[9] = NewTop + Correction;
+		if (Layout.TopApex != ControllerHull::NoApex) {
+			hkVector4& Top = NewVerts[Layout.TopApex];
+			Top = NewTop + Correction;
 
-		if (NewVerts[9].quad.m128_f32[2] <= NewVerts[8].quad.m128_f32[2]) {
-			NewVerts[9].quad.m128_f32[2] = NewVerts[8].quad.m128_f32[2] + 0.0003f;
+			if (Top.quad.m128_f32[2] <= FloorZ) {
+				Top.quad.m128_f32[2] = FloorZ + 0.0003f;
+			}
 		}
 
-		// Move the top ring
-		for (int i : { 1, 3, 4, 5, 7, 11, 13, 16 }) {
-			float y = NewVerts[i].quad.m128_f32[2] * Utils::GetBoneQuad(ActorPtr, "NPC R Clavicle [RClv]", false,true).quad.m128_f32[2] + Correction.quad.m128_f32[2];
-			float res = (y <= NewVerts[8].quad.m128_f32[2]) ? (NewVerts[8].quad.m128_f32[2] + 0.0002f) : y;
-			NewVerts[i].quad.m128_f32[2] = res;
-		}
+		//Move the rings, never below the bottom vert, and move their vertices inwards or outwards
+		RingKernel::Params Ring{};
+		Ring.ZOffset = Correction.quad.m128_f32[2];
+		Ring.ClampToFloor = true;
+		Ring.FloorZ = FloorZ;
+		Ring.Radius = OriginalConvexRadius * ActorScale; //* SwimmingMult;
+		Prepared.ColliderRadius = Ring.Radius;
+		Prepared.HasColliderSize = true;
 
-		//Move the Bottom ring
-		for (int i : { 0, 2, 6, 10, 12, 14, 15, 17 }) { //Bottom Ring
-			float x = (NewVerts[i].quad.m128_f32[2] * Utils::GetBoneQuad(ActorPtr, "NPC R RearCalf [RrClf]", true,true).quad.m128_f32[2] + Correction.quad.m128_f32[2]);
-			float res = (x <= NewVerts[8].quad.m128_f32[2]) ? (NewVerts[8].quad.m128_f32[2] + 0.0001f) : x;
-			NewVerts[i].quad.m128_f32[2] = res;
-		}
+		float (*Verts)[4] = reinterpret_cast<float (*)[4]>(NewVerts.data());
 
-		// move the rings' vertices inwards or outwards
-		for (int i : {
-			     1, 3, 4, 5, 7, 11, 13, 16,   // top ring
-				 0, 2, 6, 10, 12, 14, 15, 17  // bottom ring
-			 }) {
-			NiPoint3 vert = Utils::HkVectorToNiPoint(NewVerts[i]);
-			NiPoint3 newVert = vert;
-			newVert.z = 0;
-			newVert.Unitize();
-			newVert *= OriginalConvexRadius * ActorScale; //* SwimmingMult;
-			newVert.z = vert.z;
+		Ring.ZScale = PoseClavicleZ;
+		Ring.FloorEpsilon = 0.0002f;
+		RingKernel::Apply(Verts, Layout.TopRing.data(), Layout.RingSize, Ring);
 
-			NewVerts[i] = Utils::NiPointToHkVector(newVert);
-		}
+		Ring.ZScale = PoseCalfZ;
+		Ring.FloorEpsilon = 0.0001f;
+		RingKernel::Apply(Verts, Layout.BottomRing.data(), Layout.RingSize, Ring);
 	}
 
-	hkStridedVertices StridedVerts(NewVerts.data(), static_cast<int>(NewVerts.size()));
-	hkpConvexVerticesShape::BuildConfig BuildConfig{ false, false, true, 0.05f, 0, 0.f, 0.f, -0.1f };
-
-	hkpConvexVerticesShape* NewShape = reinterpret_cast<hkpConvexVerticesShape*>(hkHeapAlloc(sizeof(hkpConvexVerticesShape)));
-	hkpConvexVerticesShape_ctor(NewShape, StridedVerts, BuildConfig);  // sets refcount to 1
-
-	// it's actually a hkCharControllerShape not just a hkpConvexVerticesShape
-	reinterpret_cast<std::uintptr_t*>(NewShape)[0] = VTABLE_hkCharControllerShape[0].address();
-
-	bhkShape* Wrapper = ConvexShape->userData;
-	if (Wrapper) 
-		Wrapper->SetReferencedObject(NewShape);
-	
-	// The listshape does not use a hkRefPtr but it's still setup to add a reference upon construction and remove one on destruction
-	if (ListShape) {
-		ListShape->childInfo[0].shape = NewShape;
-		ConvexShape->RemoveReference();  // this will usually call the dtor on the old shape
-	} 
-	else {
-		if (CharProxy) CharProxy->shapePhantom->SetShape(NewShape);
-		else if (CharRigidBody) CharRigidBody->character->SetShape(NewShape);
-		NewShape->RemoveReference();
-	}
+	return true;
 }
 
 //NPC's
-void AdjustmentHandler::ControllerData::AdjustConvexShapeSimple(){
-	if (Settings::bEnableStateAdjustments) {
-		if (auto actor = ActorHandle.get()) {
-			RE::hkpCharacterProxy* proxy = nullptr;
-			RE::hkpCharacterRigidBody* rigidBody = nullptr;
-			RE::hkpListShape* listShape = nullptr;
-			RE::hkpConvexVerticesShape* collisionConvexVerticesShape = nullptr;
-
-			auto cell = actor->GetParentCell();
-			if (!cell) {
-				return;
-			}
-
-			auto world = RE::NiPointer<RE::bhkWorld>(cell->GetbhkWorld());
-			if (!world) {
-				return;
-			}
+bool AdjustmentHandler::ControllerData::ComputeConvexShapeSimple() {
+	if (!Settings::bEnableStateAdjustments) return false;
+	if (OriginalVerts.empty()) return false;
 
-			float sneakMult = (Sneaking && (CharacterState == RE::hkpCharacterStateType::kOnGround)) ? Settings::fSneakControllerShapeHeightMultiplier : 1.f;
-			float swimmingHeightMult = CharacterState == RE::hkpCharacterStateType::kSwimming ? Settings::fSwimmingControllerShapeHeightMultiplier : 1.f;
-			float swimmingRadiusMult = CharacterState == RE::hkpCharacterStateType::kSwimming ? Settings::fSwimmingControllerShapeRadiusMultiplier : 1.f;
+	float sneakMult = (ShapeSneaking() && (CharacterState == RE::hkpCharacterStateType::kOnGround)) ? Settings::fSneakControllerShapeHeightMultiplier : 1.f;
+	float swimmingHeightMult = CharacterState == RE::hkpCharacterStateType::kSwimming ? Settings::fSwimmingControllerShapeHeightMultiplier : 1.f;
+	float swimmingRadiusMult = CharacterState == RE::hkpCharacterStateType::kSwimming ? Settings::fSwimmingControllerShapeRadiusMultiplier : 1.f;
 
-			float heightMult = sneakMult * swimmingHeightMult * ActorScale;
-			float heightMultTop = (sneakMult * swimmingHeightMult * ActorScale);
-			float radiusMult = ActorScale * swimmingRadiusMult;
+	float heightMult = sneakMult * swimmingHeightMult * ActorScale;
+	float heightMultTop = (sneakMult * swimmingHeightMult * ActorScale);
+	float radiusMult = ActorScale * swimmingRadiusMult;
 
-			BSWriteLockGuard lock(world->worldLock);
+	std::vector<RE::hkVector4>& newVerts = Prepared.ConvexVerts;
+	newVerts.assign(OriginalVerts.begin(), OriginalVerts.end());
 
-			if (GetConvexShape(CharController, proxy, rigidBody, listShape, collisionConvexVerticesShape)) {
-				std::vector<RE::hkVector4> newVerts = OriginalVerts;
-				if (OriginalVerts.size() == 18) {
-					RE::hkVector4 topVert = OriginalVerts[9];
-					RE::hkVector4 bottomVert = OriginalVerts[8];
+	if (HasLayout) {
+		RE::hkVector4 topVert = OriginalTop;
+		RE::hkVector4 bottomVert = OriginalBottom;
 
-					RE::hkVector4 newTopVert = ((topVert * 2.f) * heightMultTop) + bottomVert;
-					float distance = topVert.GetDistance3(newTopVert);
+		RE::hkVector4 newTopVert = ((topVert * 2.f) * heightMultTop) + bottomVert;
+		Prepared.ColliderHeight = ((topVert * 2.f) * ActorScale) + bottomVert;
+		float distance = topVert.GetDistance3(newTopVert);
 
-					// Move the top vert
+		// Move the top vert
+		if (Layout.TopApex != ControllerHull::NoApex) {
+			newVerts[Layout.TopApex] = newTopVert;
+		}
 
-					newVerts[9] = newTopVert;
-					// Move the top ring
-					for (int i : { 1, 3, 4, 5, 7, 11, 13, 16 }) {  // top ring
-						if (heightMult < 1.f) {
-							newVerts[i].quad.m128_f32[2] = newVerts[i].quad.m128_f32[2] - distance;
-						} else {
-							newVerts[i].quad.m128_f32[2] = newVerts[i].quad.m128_f32[2] + distance;
-						}
-					}
+		// Move the top ring and move the rings' vertices inwards or outwards
+		RingKernel::Params ring{};
+		ring.Radius = OriginalConvexRadius * radiusMult;
+		Prepared.ColliderRadius = ring.Radius;
+		Prepared.HasColliderSize = true;
 
-					// move the rings' vertices inwards or outwards
-					for (int i : {
-							 1, 3, 4, 5, 7, 11, 13, 16,   // top ring
-							 0, 2, 6, 10, 12, 14, 15, 17  // bottom ring
-						 }) {
-						RE::NiPoint3 vert = Utils::HkVectorToNiPoint(newVerts[i]);
-						RE::NiPoint3 newVert = vert;
-						newVert.z = 0;
-						newVert.Unitize();
-						newVert *= OriginalConvexRadius * radiusMult;
-						newVert.z = vert.z;
-
-						newVerts[i] = Utils::NiPointToHkVector(newVert);
-					}
-				}
+		float (*verts)[4] = reinterpret_cast<float (*)[4]>(newVerts.data());
 
-				RE::hkStridedVertices stridedVerts(newVerts.data(), static_cast<int>(newVerts.size()));
-				RE::hkpConvexVerticesShape::BuildConfig buildConfig{ false, false, true, 0.05f, 0, 0.f, 0.f, -0.1f };
+		ring.ZOffset = heightMult < 1.f ? -distance : distance;
+		RingKernel::Apply(verts, Layout.TopRing.data(), Layout.RingSize, ring);
 
-				RE::hkpConvexVerticesShape* newShape = reinterpret_cast<RE::hkpConvexVerticesShape*>(hkHeapAlloc(sizeof(RE::hkpConvexVerticesShape)));
-				hkpConvexVerticesShape_ctor(newShape, stridedVerts, buildConfig);  // sets refcount to 1
+		ring.ZOffset = 0.f;
+		RingKernel::Apply(verts, Layout.BottomRing.data(), Layout.RingSize, ring);
+	}
 
-				// it's actually a hkCharControllerShape not just a hkpConvexVerticesShape
-				reinterpret_cast<std::uintptr_t*>(newShape)[0] = RE::VTABLE_hkCharControllerShape[0].address();
+	return true;
+}
 
-				RE::bhkShape* wrapper = collisionConvexVerticesShape->userData;
-				if (wrapper) {
-					wrapper->SetReferencedObject(newShape);
-				}
+//Builds the hull, does not touch the world so no lock is needed. Main thread only, havok's heap is per thread
+hkpConvexVerticesShape* AdjustmentHandler::BuildConvexShape(const std::vector<hkVector4>& Verts, const ControllerHull::Topology* Layout) {
+	ControllerHull::Result Hull;
+	if (BuildHull(Verts, Layout, Hull)) {
+		Stats::Frame.SpecializedHulls++;
+		return CreateHullShape(Hull);
+	}
 
-				// The listshape does not use a hkRefPtr but it's still setup to add a reference upon construction and remove one on destruction
-				if (listShape) {
-					listShape->childInfo[0].shape = newShape;
-					collisionConvexVerticesShape->RemoveReference();  // this will usually call the dtor on the old shape
-
-				// We don't need to remove a ref here, the ctor gave it a refcount of 1 and we assigned it to the listShape which isn't technically a hkRefPtr but still owns it (and the listShape's dtor will decref anyways)
-				//newShape->RemoveReference();
-				} else {
-					if (proxy) {
-						proxy->shapePhantom->SetShape(newShape);
-					} else if (rigidBody) {
-						rigidBody->character->SetShape(newShape);
-					}
+	Stats::Frame.GenericHulls++;
+	Stats::Frame.ShapeAllocations++;
 
-					newShape->RemoveReference();
-				}
-			}
-		}
-	}
-}
+	hkStridedVertices StridedVerts(Verts.data(), static_cast<int>(Verts.size()));
+	hkpConvexVerticesShape::BuildConfig BuildConfig{ false, false, true, 0.05f, 0, 0.f, 0.f, -0.1f };
 
-//-----------------------
-//	Controller Events
-//-----------------------
+	hkpConvexVerticesShape* NewShape = reinterpret_cast<hkpConvexVerticesShape*>(hkHeapAlloc(sizeof(hkpConvexVerticesShape)));
+	hkpConvexVerticesShape_ctor(NewShape, StridedVerts, BuildConfig);  // sets refcount to 1
 
-//Update Sneak State
-void AdjustmentHandler::ActorSneakStateChanged(ActorHandle ActorHandle, bool Sneaking) {
+	// it's actually a hkCharControllerShape not just a hkpConvexVerticesShape
+	reinterpret_cast<std::uintptr_t*>(NewShape)[0] = VTABLE_hkCharControllerShape[0].address();
 
-	if (std::shared_ptr<ControllerData> ControllerData = GetControllerData(ActorHandle)) {
-		ControllerData->Sneaking = Sneaking;
+	if (!TemplateConvexShape) {
+		NewShape->AddReference();
+		TemplateConvexShape = NewShape;
 	}
-}
 
-//Update Character State
-void AdjustmentHandler::CharacterControllerStateChanged(bhkCharacterController* Controller, hkpCharacterStateType CurrentState) {
-	if (std::shared_ptr<ControllerData> ControllerData = GetControllerData(Controller)) {
-		ControllerData->CharacterState = CurrentState;
-	}
+	return NewShape;
 }
 
-//-----------------------
-//	Main Update
-//-----------------------
+//The controller layout has its faces known up front, false if the general hull builder has to be used
+bool AdjustmentHandler::BuildHull(const std::vector<hkVector4>& Verts, const ControllerHull::Topology* Layout, ControllerHull::Result& OutHull) {
+	static_assert(sizeof(ControllerHull::Vector) == sizeof(hkVector4));
 
-void AdjustmentHandler::ForEachController(std::function<void(std::shared_ptr<ControllerData>)> Func) {
-	ReadLocker locker(ControllersLock);
+	if (!TemplateConvexShape || !Layout) return false;
+	if (!ControllerHull::Matches(*Layout, Verts.size())) return false;
 
-	for (std::pair<bhkCharacterController* const, std::shared_ptr<ControllerData>>& Entry : ControllerMap) {
-		Func(Entry.second);
-	}
+	return ControllerHull::Build(*Layout, reinterpret_cast<const ControllerHull::Vector*>(Verts.data()), Verts.size(), OutHull);
 }
 
-void AdjustmentHandler::Update() {
-	//Dont Run if paused
-	if (UI::GetSingleton()->GameIsPaused()) {
-		return;
-	}
+//Writes a specialized hull into a pooled shape, or a new one with everything the general builder would have set up copied from the template
+hkpConvexVerticesShape* AdjustmentHandler::CreateHullShape(const ControllerHull::Result& Hull) {
+	static_assert(sizeof(ControllerHull::FourVectors) == sizeof(hkpConvexVerticesShape::FourVectors));
+	static_assert(sizeof(ControllerHull::Vector) == sizeof(hkVector4));
 
-	ActorHandle PlayerHandle = PlayerCharacter::GetSingleton()->GetHandle();
-	if (!PlayerHandle) return;
+	while (!ShapePool.empty()) {
+		hkpConvexVerticesShape* Pooled = ShapePool.back();
+		ShapePool.pop_back();
 
-	auto ActorPtr = PlayerHandle.get();
-	if (!ActorPtr) return;
+		if (RewriteHullShape(Pooled, Hull)) {
+			Stats::Frame.ShapesRecycled++;
+			return Pooled;  //The pool's reference becomes the caller's
+		}
 
-	auto Cell = ActorPtr->GetParentCell();
-	if (!Cell) return;
+		Pooled->RemoveReference();
+	}
 
-	auto World = Cell->GetbhkWorld();
-	if (!World) return;
+	Stats::Frame.ShapeAllocations++;
 
-	BSReadWriteLock Lock(World->worldLock);
+	hkpConvexVerticesShape* NewShape = reinterpret_cast<hkpConvexVerticesShape*>(hkHeapAlloc(sizeof(hkpConvexVerticesShape)));
+	std::memcpy(NewShape, TemplateConvexShape, sizeof(hkpConvexVerticesShape));
+
+	NewShape->referenceCount = 1;
+	NewShape->userData = nullptr;
+	NewShape->connectivity = nullptr;
+
+	std::memcpy(&NewShape->aabbCenter, &Hull.AabbCenter, sizeof(hkVector4));
+	std::memcpy(&NewShape->aabbHalfExtents, &Hull.AabbHalfExtents, sizeof(hkVector4));
+	NewShape->numVertices = static_cast<int32_t>(Hull.VertexCount);
+
+	const auto FillArray = [](void* Array, const void* Source, int32_t Count, int32_t ElementSize) {
+		int32_t Bytes = Count * ElementSize;
+		hkRawArray& Raw = *reinterpret_cast<hkRawArray*>(Array);
+		Raw.data = hkHeapBufAlloc(Bytes);
+		Raw.size = Count;
+		Raw.capacityAndFlags = Bytes / ElementSize;
+		std::memcpy(Raw.data, Source, static_cast<size_t>(Count) * ElementSize);
+	};
 
-	ForEachController([&](std::shared_ptr<ControllerData> Entry) {
-		CharacterControllerUpdate(Entry->CharController);
-	});
+	FillArray(&NewShape->rotatedVertices, Hull.Blocks.data(), static_cast<int32_t>(Hull.BlockCount), sizeof(ControllerHull::FourVectors));
+	FillArray(&NewShape->planeEquations, Hull.Planes.data(), static_cast<int32_t>(Hull.PlaneCount), sizeof(ControllerHull::Vector));
 
+	return NewShape;
 }
 
-void AdjustmentHandler::CharacterControllerUpdate(bhkCharacterController* Controller) {
-	if (!Settings::bEnableActorScaleFix) return;
+namespace {
+	constexpr int32_t hkArrayCapacityMask = 0x3FFFFFFF;
+	constexpr int32_t hkArrayDontDeallocate = static_cast<int32_t>(0x80000000);
+}
 
-	std::shared_ptr<ControllerData> ControllerData = GetControllerData(Controller);
-	if (!ControllerData) return;
+//Only shapes laid out like the ones we build, with storage that belongs to them
+bool AdjustmentHandler::CanRewriteShape(const hkpConvexVerticesShape* Shape) {
+	if (reinterpret_cast<const std::uintptr_t*>(Shape)[0] != VTABLE_hkCharControllerShape[0].address()) return false;
+	if (Shape->connectivity) return false;
 
-	NiPointer<Actor> NiActor = ControllerData->ActorHandle.get();
-	if (!NiActor) return;
-	if (NiActor->IsDead()) return;
+	const hkRawArray& Blocks = *reinterpret_cast<const hkRawArray*>(&Shape->rotatedVertices);
+	const hkRawArray& Planes = *reinterpret_cast<const hkRawArray*>(&Shape->planeEquations);
+	return (Blocks.capacityAndFlags & hkArrayDontDeallocate) == 0 && (Planes.capacityAndFlags & hkArrayDontDeallocate) == 0;
+}
 
-	Actor* ActorPtr = NiActor.get();
-	if (!ActorPtr) return;
+//Overwrites a shape's hull without touching its allocations, false if the shape can't take the new hull
+bool AdjustmentHandler::RewriteHullShape(hkpConvexVerticesShape* Shape, const ControllerHull::Result& Hull) {
+	if (!CanRewriteShape(Shape)) return false;
+	if (Shape->numVertices != static_cast<int32_t>(Hull.VertexCount)) return false;
 
-	float CurrentScale = Utils::GetScale(ActorPtr);
-	bool ScaleUnchanged = Utils::FloatsEqual(CurrentScale, ControllerData->ActorScale);
-	//bool ScaleUnchancedBigDelta = Utils::FloatsEqualDelta(ControllerData->OldActorScale, ControllerData->ActorScale, 0.1f);
+	hkRawArray& Blocks = *reinterpret_cast<hkRawArray*>(&Shape->rotatedVertices);
+	hkRawArray& Planes = *reinterpret_cast<hkRawArray*>(&Shape->planeEquations);
+	if ((Blocks.capacityAndFlags & hkArrayCapacityMask) < static_cast<int32_t>(Hull.BlockCount)) return false;
+	if ((Planes.capacityAndFlags & hkArrayCapacityMask) < static_cast<int32_t>(Hull.PlaneCount)) return false;
 
-	//Update Scale
-	ControllerData->ActorScale = CurrentScale; 
+	std::memcpy(Blocks.data, Hull.Blocks.data(), Hull.BlockCount * sizeof(ControllerHull::FourVectors));
+	std::memcpy(Planes.data, Hull.Planes.data(), Hull.PlaneCount * sizeof(ControllerHull::Vector));
+	Blocks.size = static_cast<int32_t>(Hull.BlockCount);
+	Planes.size = static_cast<int32_t>(Hull.PlaneCount);
 
-	//The Player And Followers Get Realtime ConvexShape Update Based On Bone Position
-	if (ActorPtr->formID == 0x14 || ActorPtr->IsPlayerTeammate()) {
-		ControllerData->AdjustConvexShape();
-		ControllerData->AdjustProxyCapsule();
-		return;
-	}
-	//Revert this for the "public" release
+	std::memcpy(&Shape->aabbCenter, &Hull.AabbCenter, sizeof(hkVector4));
+	std::memcpy(&Shape->aabbHalfExtents, &Hull.AabbHalfExtents, sizeof(hkVector4));
+	return true;
+}
 
-	//if (ActorPtr->IsPlayerTeammate()) {
-	//	if (CurrentScale > 1.05f)
-	//		ControllerData->ActorScale = 1.05f;
-	//	ControllerData->AdjustConvexShapeSimple();
-	//	ControllerData->AdjustProxyCapsuleSimple();
-	//	return;
-	//}
-	//Non Creatures NPC's Get A Simpeler Scale Based One. Only Update If Scale Unchanged
-	if(!ScaleUnchanged && !ControllerData->IsCreature) {
-		ControllerData->AdjustConvexShapeSimple();
-		ControllerData->AdjustProxyCapsuleSimple();
+//Drops a reference, a shape this would destroy goes to the pool instead if it can be rewritten later
+void AdjustmentHandler::ReleaseShape(hkpConvexVerticesShape* Shape) {
+	if (Shape->GetReferenceCount() == 1 && ShapePool.size() < MaxPooledShapes && CanRewriteShape(Shape)) {
+		Shape->userData = nullptr;
+		ShapePool.push_back(Shape);
 		return;
 	}
 
-	// if (ControllerData->IsCreature && !ScaleUnchancedBigDelta) {
-	// 	ControllerData->AdjustProxyCapsuleCreature_Hack();
-	// }
-
+	Shape->RemoveReference();
 }
 
 //-----------------------
-//	Debug Draw
+//	Shape Variants
 //-----------------------
 
-void DrawLine(hkVector4& Start, hkVector4& End, NiPoint3& ControllerPosition) {
-	NiPoint3 S = Utils::HkVectorToNiPoint(Start) * *g_worldScaleInverse;
-	NiPoint3 E = Utils::HkVectorToNiPoint(End) * *g_worldScaleInverse;
-	S += ControllerPosition;
-	E += ControllerPosition;
-	Settings::g_trueHUD->DrawLine(S, E, 0.f, 0x00FF00FF,2);
+//Quantized scale in the upper bits, the movement state that changes the simple shape in the lower two
+uint32_t AdjustmentHandler::ControllerData::ShapeVariantKey() const {
+	uint32_t State = 0;
+	if (CharacterState == hkpCharacterStateType::kSwimming) State = 2;
+	else if (ShapeSneaking() && CharacterState == hkpCharacterStateType::kOnGround) State = 1;
+
+	const uint32_t QuantizedScale = static_cast<uint32_t>(std::lround(std::max(ActorScale, 0.f) / ShapeVariantScaleStep));
+	return (QuantizedScale << 2) | State;
 }
 
-void AdjustmentHandler::DebugDraw() {
-	TRUEHUD_API::IVTrueHUD4* TrueHUD = Settings::g_trueHUD;
-	if (!TrueHUD || Settings::uDisplayDebugShapes == DebugDrawMode::kNone) return;
+//Everything ComputeConvexShapeSimple depends on
+ShapeInternTable::Key AdjustmentHandler::ControllerData::ShapeInternKey() const {
+	const uint32_t VariantKey = ShapeVariantKey();
+	return ShapeInternTable::Key{
+		OriginalVertsHash,
+		VariantKey >> 2,
+		VariantKey & 3,
+		std::bit_cast<uint32_t>(Settings::fSneakControllerShapeHeightMultiplier),
+		std::bit_cast<uint32_t>(Settings::fSwimmingControllerShapeHeightMultiplier),
+		std::bit_cast<uint32_t>(Settings::fSwimmingControllerShapeRadiusMultiplier)
+	};
+}
 
-	if (UI::GetSingleton()->GameIsPaused()) return;
+hkpConvexVerticesShape* AdjustmentHandler::ControllerData::FindShapeVariant(uint32_t Key) {
+	for (ShapeVariant& Variant : ShapeVariants) {
+		if (Variant.Shape && Variant.Key == Key) {
+			Variant.LastUse = ++ShapeVariantClock;
+			return Variant.Shape.get();
+		}
+	}
+	return nullptr;
+}
+
+void AdjustmentHandler::ControllerData::StoreShapeVariant(uint32_t Key, hkpConvexVerticesShape* Shape) {
+	//Free slot first, then the least recently used shape nobody but the cache holds, then the least recently used one.
+	//Evicting only drops the cache's reference, a shape havok still uses stays alive until havok lets go of it
+	ShapeVariant* Target = nullptr;
+	for (ShapeVariant& Variant : ShapeVariants) {
+		if (!Variant.Shape) {
+			Target = &Variant;
+			break;
+		}
+	}
+
+	if (!Target) {
+		for (ShapeVariant& Variant : ShapeVariants) {
+			if (Variant.Shape->GetReferenceCount() > 1) continue;
+			if (!Target || Variant.LastUse < Target->LastUse) Target = &Variant;
+		}
+	}
+
+	if (!Target) {
+		for (ShapeVariant& Variant : ShapeVariants) {
+			if (!Target || Variant.LastUse < Target->LastUse) Target = &Variant;
+		}
+	}
+
+	if (Target->Shape) {
+		Stats::Frame.ShapeCacheEvictions++;
+	}
+
+	Target->Key = Key;
+	Target->LastUse = ++ShapeVariantClock;
+	Target->Shape = hkRefPtr<hkpConvexVerticesShape>(Shape);  //Adds the cache's reference
+}
+
+void AdjustmentHandler::ControllerData::ClearShapeVariants() {
+	for (ShapeVariant& Variant : ShapeVariants) {
+		Variant.Shape.reset();
+	}
+}
+
+//-----------------------
+//	Commit
+//-----------------------
+
+//Swaps the prepared shapes into havok, the caller has to hold the world's write lock
+void AdjustmentHandler::ControllerData::CommitShapes() {
+	if (!CharController) return;
+
+	int8_t shapeIdx = 1;
+	if (!CharController->shapes[shapeIdx]) shapeIdx = 0;
+	const bool HasShape = CharController->shapes[shapeIdx] != nullptr;
+
+	//Readers outside the update (the sneak button) only ever see extents published from the main thread
+	if (std::exchange(Prepared.HasColliderSize, false)) {
+		CachedColliderHeight = Prepared.ColliderHeight;
+		ColliderRadius = Prepared.ColliderRadius;
+	}
+
+	if (Prepared.HasHull) {
+		Prepared.HasHull = false;
+		if (!RewriteCommittedShape()) {
+			Prepared.ConvexShape = CreateHullShape(Prepared.Hull);
+		}
+	}
+
+	if (hkpConvexVerticesShape* NewShape = std::exchange(Prepared.ConvexShape, nullptr)) {
+		ShapeLookup& Lookup = LookupShapes();
+		hkpListShape* ListShape = Lookup.ListShape;
+		hkpCharacterProxy* CharProxy = Lookup.Proxy;
+		hkpConvexVerticesShape* ConvexShape = Lookup.ConvexShape;
+		hkpCharacterRigidBody* CharRigidBody = Lookup.RigidBody;
+
+		if (Lookup.HasConvexShape()) {
+			//Held until the swap is done, then it either dies or gets pooled
+			ConvexShape->AddReference();
+
+			bhkShape* Wrapper = ConvexWrapper ? ConvexWrapper.get() : ConvexShape->userData;
+			if (Wrapper) {
+				//An interned shape keeps pointing at the wrapper of whoever built it, only point our wrapper at the shape
+				if (NewShape->userData && NewShape->userData != Wrapper)
+					Wrapper->referencedObject.reset(NewShape);
+				else
+					Wrapper->SetReferencedObject(NewShape);
+			}
+
+			CommittedConvexShape = NewShape;
+
+			// The listshape does not use a hkRefPtr but it's still setup to add a reference upon construction and remove one on destruction
+			if (ListShape) {
+				ListShape->childInfo[0].shape = NewShape;
+				ConvexShape->RemoveReference();
+				Lookup.ConvexShape = NewShape;
+			}
+			else {
+				if (CharProxy) CharProxy->shapePhantom->SetShape(NewShape);
+				else if (CharRigidBody) CharRigidBody->character->SetShape(NewShape);
+				NewShape->RemoveReference();
+				Lookup.Valid = false;
+			}
+
+			ReleaseShape(ConvexShape);  // this would usually call the dtor on the old shape
+		}
+		else {
+			//Nothing to put it in anymore
+			NewShape->RemoveReference();
+		}
+	}
+
+	if (Prepared.HasCapsules && HasShape) {
+		const ShapeLookup& Lookup = LookupShapes();
+		const CapsuleList& Capsules = Lookup.Capsules;
+
+		//Scatter the kernel's results back, x and w are never touched so the originals are the base
+		if ((!Prepared.RigidBodyCapsulesOnly || Lookup.IsRigidBodyController) && !Capsules.empty() && Capsules.size() == Prepared.CapsuleCount) {
+			for (size_t i = 0ull; i < Capsules.size(); i++) {
+				const CapsuleKernel::Capsule Target = CapsuleBatch.Get(Prepared.CapsuleOffset + i);
+				Capsules[i]->radius = Target.Radius;
+				Capsules[i]->vertexA = OriginalCapsuleA[i];
+				Capsules[i]->vertexA.quad.m128_f32[1] = Target.AY;
+				Capsules[i]->vertexA.quad.m128_f32[2] = Target.AZ;
+				Capsules[i]->vertexB = OriginalCapsuleB[i];
+				Capsules[i]->vertexB.quad.m128_f32[1] = Target.BY;
+				Capsules[i]->vertexB.quad.m128_f32[2] = Target.BZ;
+			}
+
+			ColliderCapsuleA = Capsules[0]->vertexA;
+			ColliderCapsuleB = Capsules[0]->vertexB;
+			ColliderCapsuleRadius = Capsules[0]->radius;
+		}
+	}
+
+	Prepared.HasCapsules = false;
+	Prepared.HasConvexVerts = false;
+	Prepared.World.reset();
+}
+
+//Rewrites the installed shape's hull in place if nothing but this controller's list shape and wrapper reference it
+bool AdjustmentHandler::ControllerData::RewriteCommittedShape() {
+	const ShapeLookup& Lookup = LookupShapes();
+	if (!Lookup.HasConvexShape()) return false;
+
+	hkpListShape* ListShape = Lookup.ListShape;
+	hkpConvexVerticesShape* ConvexShape = Lookup.ConvexShape;
+
+	//The phantom and rigid body need SetShape to pick up a new shape, only the list shape reads its child as is
+	if (!ListShape || ListShape->childInfo[0].shape != ConvexShape) return false;
+
+	const bhkShape* Wrapper = ConvexWrapper ? ConvexWrapper.get() : ConvexShape->userData;
+	int32_t OwnReferences = 1;
+	if (Wrapper && Wrapper->referencedObject.get() == ConvexShape) OwnReferences++;
+
+	if (ConvexShape->GetReferenceCount() != OwnReferences) return false;
+	if (!RewriteHullShape(ConvexShape, Prepared.Hull)) return false;
+
+	CommittedConvexShape = ConvexShape;
+	Stats::Frame.ShapesRewritten++;
+	return true;
+}
+
+//-----------------------
+//	Dirty Tracking
+//-----------------------
+
+//Returns true once the tracked bones in this frame's snapshot moved further than the tolerance since the last rebuild
+bool AdjustmentHandler::ControllerData::SamplePose() {
+	const hkVector4 Head = Pose.Head;
+	const float ClavicleZ = Pose.ClavicleZ;
+	const float CalfZ = Pose.CalfZ;
+
+	float Delta = std::max(std::abs(ClavicleZ - PoseClavicleZ), std::abs(CalfZ - PoseCalfZ));
+	for (int i = 0; i < 3; i++) {
+		Delta = std::max(Delta, std::abs(Head.quad.m128_f32[i] - PoseHead.quad.m128_f32[i]));
+	}
+
+	if (Delta < PoseTolerance) return false;
+
+	PoseHead = Head;
+	PoseClavicleZ = ClavicleZ;
+	PoseCalfZ = CalfZ;
+	return true;
+}
+
+//Distance based tier with hysteresis, an actor has to move past the boundary by fLODHysteresis before its tier changes
+AdjustmentHandler::ControllerData::LODTier AdjustmentHandler::ControllerData::SelectLOD(float Distance) const {
+	const float Near = Settings::fLODNearDistance;
+	const float Far = std::max(Settings::fLODFarDistance, Near);
+	const float Hysteresis = Settings::fLODHysteresis;
+
+	switch (LOD) {
+		case LODTier::kNear: {
+			if (Distance > Far + Hysteresis) return LODTier::kFar;
+			if (Distance > Near + Hysteresis) return LODTier::kMid;
+			return LODTier::kNear;
+		}
+		case LODTier::kMid: {
+			if (Distance < Near - Hysteresis) return LODTier::kNear;
+			if (Distance > Far + Hysteresis) return LODTier::kFar;
+			return LODTier::kMid;
+		}
+		case LODTier::kFar:
+		default: {
+			if (Distance < Near - Hysteresis) return LODTier::kNear;
+			if (Distance < Far - Hysteresis) return LODTier::kMid;
+			return LODTier::kFar;
+		}
+	}
+}
+
+//Shapes no bigger than the vanilla one fit wherever the game lets the actor stand, so only scaled npc's get held.
+//Once ResolveStandClearance found room the held changes go through together. The room stays found until the npc grows past
+//the scale that was checked or walks away from where it was checked, growth up to there isn't held again
+float AdjustmentHandler::ControllerData::HoldForClearance(bool CanHold) {
+	const float Target = Pose.Scale;
+
+	if (ClearedScale > 0.f) {
+		RE::hkVector4 Origin{};
+		CharController->GetPosition(Origin, false);
+		if (Target > ClearedScale || Origin.GetDistance3(ClearedOrigin) > ClearedTolerance) ClearedScale = 0.f;
+	}
+
+	if (!CanHold || ClearedScale > 0.f || std::max(Target, ActorScale) <= 1.f) {
+		if (StandHeld) Dirty |= kDirtySneak;
+		StandHeld = false;
+		HeldScale = 0.f;
+		StandMarginBlocked = false;
+		return Target;
+	}
+
+	//Sneaking again needs no room, standing up does until the shape caught up with it
+	if (Sneaking) {
+		StandHeld = false;
+	} else if (Dirty & kDirtySneak) {
+		StandHeld = true;
+	}
+	if (StandHeld) Dirty &= ~kDirtySneak;
+
+	//Shrinking never needs room
+	if (Target > ActorScale && !Utils::FloatsEqual(Target, ActorScale)) {
+		HeldScale = Target;
+		Dirty &= ~kDirtyScale;
+		return ActorScale;
+	}
+
+	HeldScale = 0.f;
+	return Target;
+}
+
+//-----------------------
+//	Controller Events
+//-----------------------
+
+//Update Sneak State
+void AdjustmentHandler::ActorSneakStateChanged(Actor* ActorPtr, bool Sneaking) {
+	if (bhkCharacterController* Controller = ActorPtr->GetCharController()) {
+		ControllerEvent Event{ Controller, ControllerEvent::Type::kSneak };
+		Event.Sneaking = Sneaking;
+		QueueControllerEvent(Event);
+	}
+}
+
+//Update Character State
+void AdjustmentHandler::CharacterControllerStateChanged(bhkCharacterController* Controller, hkpCharacterStateType CurrentState) {
+	ControllerEvent Event{ Controller, ControllerEvent::Type::kCharacterState };
+	Event.CharacterState = CurrentState;
+	QueueControllerEvent(Event);
+}
+
+//Hooks only pay for a single push, the lookup happens on the main thread when the queue gets drained.
+//A full queue (game paused for a long time?) spills into a locked overflow, events are only ever applied on the main thread
+void AdjustmentHandler::QueueControllerEvent(const ControllerEvent& Event) {
+	ControllerEvents.Push(Event);
+}
+
+void AdjustmentHandler::ApplyControllerEvent(ControllerData& Data, const ControllerEvent& Event) {
+	switch (Event.EventType) {
+		case ControllerEvent::Type::kSneak: {
+			if (Data.Sneaking != Event.Sneaking) {
+				Data.Dirty |= ControllerData::kDirtySneak;
+			}
+			Data.Sneaking = Event.Sneaking;
+			break;
+		}
+		case ControllerEvent::Type::kCharacterState: {
+			if (Data.CharacterState != Event.CharacterState) {
+				Data.Dirty |= ControllerData::kDirtyCharacterState;
+			}
+			Data.CharacterState = Event.CharacterState;
+			break;
+		}
+		case ControllerEvent::Type::kClearance: {
+			Data.Clearance = static_cast<uint8_t>(Event.HasSpace ? DCA_API::Clearance::Clear : DCA_API::Clearance::Blocked);
+			Data.ClearanceFrame = Stats::FrameIndex;
+			Data.ClearanceTime = std::chrono::steady_clock::now();
+			break;
+		}
+		case ControllerEvent::Type::kRemoved: {
+			break;
+		}
+	}
+}
+
+void AdjustmentHandler::DrainControllerEvents() {
+	PendingEvents.clear();
+	ControllerEvents.Drain([](const ControllerEvent& Event) {
+		PendingEvents.push_back(Event);
+	});
+
+	if (PendingEvents.empty()) return;
+
+	//Group the events per controller while keeping their order, then only do one lookup per controller.
+	//Repeated transitions collapse into the last one since every event overwrites the previous value.
+	std::stable_sort(PendingEvents.begin(), PendingEvents.end(), [](const ControllerEvent& A, const ControllerEvent& B) {
+		return A.Controller < B.Controller;
+	});
+
+	const bool HasRemovals = std::any_of(PendingEvents.begin(), PendingEvents.end(), [](const ControllerEvent& Event) {
+		return Event.EventType == ControllerEvent::Type::kRemoved;
+	});
+
+	if (HasRemovals) {
+		WriteLocker lock(ControllersLock);
+		for (const ControllerEvent& Event : PendingEvents) {
+			if (Event.EventType == ControllerEvent::Type::kRemoved) {
+				Controllers.Erase(Event.Removed);
+			}
+		}
+	}
+
+	ReadLocker locker(ControllersLock);
+
+	for (size_t i = 0; i < PendingEvents.size();) {
+		bhkCharacterController* Controller = PendingEvents[i].Controller;
+
+		//Whatever was queued up to a removal was meant for the destroyed controller, a new one the game put at the same
+		//address only gets what came after it
+		size_t First = i;
+		size_t End = i;
+		for (; End < PendingEvents.size() && PendingEvents[End].Controller == Controller; End++) {
+			if (PendingEvents[End].EventType == ControllerEvent::Type::kRemoved) First = End + 1;
+		}
+
+		ControllerData* Data = First < End ? GetControllerData(Controller) : nullptr;
+		for (i = First; i < End; i++) {
+			if (Data) {
+				ApplyControllerEvent(*Data, PendingEvents[i]);
+			}
+		}
+	}
+}
+
+void AdjustmentHandler::QueueScaleOverrides(const DCA_API::ScaleUpdate* Updates, size_t Count) {
+	std::lock_guard<std::mutex> Guard(ScaleOverrideLock);
+	for (size_t i = 0; i < Count; i++) {
+		const DCA_API::ScaleUpdate& Update = Updates[i];
+		if (!Update.actorHandle) continue;
+		if (!std::isfinite(Update.scale) || Update.scale < 0.f) continue;
+		QueuedScaleOverrides.push_back(Update);
+	}
+}
+
+void AdjustmentHandler::QueueReleaseAllScaleOverrides() {
+	std::lock_guard<std::mutex> Guard(ScaleOverrideLock);
+	QueuedScaleOverrides.push_back({});
+}
+
+//Only the pushed actors' controllers get touched, the scale compare in CharacterControllerUpdate marks them dirty
+void AdjustmentHandler::DrainScaleOverrides() {
+	{
+		std::lock_guard<std::mutex> Guard(ScaleOverrideLock);
+		if (QueuedScaleOverrides.empty()) return;
+		std::swap(PendingScaleOverrides, QueuedScaleOverrides);
+	}
+
+	ReadLocker locker(ControllersLock);
+
+	for (const DCA_API::ScaleUpdate& Update : PendingScaleOverrides) {
+		if (!Update.actorHandle) {
+			ScaleOverrides.clear();
+			for (ControllerData& Data : Controllers) {
+				Data.PushedScale = 0.f;
+			}
+			continue;
+		}
+
+		//Same limits as the polled scale
+		const float Scale = Update.scale > 0.f ? std::clamp(Update.scale, 0.15f, 20.f) : 0.f;
+		if (Scale > 0.f) {
+			ScaleOverrides[Update.actorHandle] = Scale;
+		} else {
+			ScaleOverrides.erase(Update.actorHandle);
+		}
+
+		if (ControllerData* Data = GetControllerData(Update.actorHandle)) {
+			Data->PushedScale = Scale;
+			Data->PushedScaleChecked = true;
+		}
+	}
+
+	PendingScaleOverrides.clear();
+}
+
+//-----------------------
+//	Main Update
+//-----------------------
+
+void AdjustmentHandler::Update() {
+	DrainControllerEvents();
+	DrainScaleOverrides();
+
+	//Dont Run if paused
+	if (UI::GetSingleton()->GameIsPaused()) {
+		return;
+	}
+
+	ActorHandle PlayerHandle = PlayerCharacter::GetSingleton()->GetHandle();
+	if (!PlayerHandle) return;
+
+	auto ActorPtr = PlayerHandle.get();
+	if (!ActorPtr) return;
+
+	auto Cell = ActorPtr->GetParentCell();
+	if (!Cell) return;
+
+	auto World = Cell->GetbhkWorld();
+	if (!World) return;
+
+	BSReadWriteLock Lock(World->worldLock);
+
+	const auto UpdateStart = std::chrono::steady_clock::now();
+
+	NiPoint3 CameraPosition = ActorPtr->GetPosition();
+	if (PlayerCamera* Camera = PlayerCamera::GetSingleton(); Camera && Camera->cameraRoot) {
+		CameraPosition = Camera->cameraRoot->world.translate;
+	}
+
+	ReadLocker locker(ControllersLock);
+
+	//Cheap pass over every controller, only the ones with dirty shapes become a job
+	AdjustmentScheduler.Clear();
+	for (size_t i = 0; i < Controllers.Size(); i++) {
+		ControllerData& Entry = Controllers[i];
+		if (CharacterControllerUpdate(Entry, CameraPosition)) {
+			AdjustmentScheduler.Push(static_cast<uint32_t>(i), Entry.ScheduleTier, Entry.CameraDistance, Entry.ScheduleAge);
+		}
+	}
+
+	const float Budget = Settings::fFrameBudgetMicroseconds > 0.f ? Settings::fFrameBudgetMicroseconds : std::numeric_limits<float>::infinity();
+
+	//Player first, then followers, then npc's by distance. Whatever does not fit stays dirty and ages until it gets its turn
+	//The shape math of a batch runs on the worker pool, nothing in havok is touched until the commit
+	ThreadPool* Pool = ThreadPool::GetSingleton();
+	if (WorkerSettingsVersion != Settings::uSettingsVersion) {
+		WorkerSettingsVersion = Settings::uSettingsVersion;
+		Pool->Resize(Settings::uWorkerThreads);
+	}
+
+	const size_t BatchSize = std::max<size_t>((Pool->WorkerCount() + 1) * 4, 8);
+
+	CommitList.clear();
+	CapsuleBatch.Clear();
+	const size_t Processed = AdjustmentScheduler.Run(Budget, Settings::uMaxBacklog, BatchSize, [&](const Scheduler::Job* Jobs, size_t Count) {
+		BatchList.clear();
+		for (size_t i = 0; i < Count; i++) {
+			ControllerData& Entry = Controllers[Jobs[i].Id];
+			if (PrepareControllerShapes(Entry)) {
+				BatchList.push_back(Jobs[i].Id);
+			}
+			Entry.ScheduleAge = 0;
+		}
+
+		const auto ComputeStart = std::chrono::steady_clock::now();
+		Pool->ParallelFor(BatchList.size(), 2, [](size_t Index) {
+			ComputeControllerShapes(Controllers[BatchList[Index]]);
+		});
+		Stats::Frame.ComputeMicroseconds += std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - ComputeStart).count();
+
+		//Havok's heap allocator is per thread, so the hulls get built here on the main thread
+		for (uint32_t Id : BatchList) {
+			ControllerData& Entry = Controllers[Id];
+			//Capsules get queued, one kernel pass over the whole frame runs once every batch is done
+			if (Entry.Prepared.Pending & ControllerData::CapsuleDirtyMask) {
+				Entry.Prepared.HasCapsules = Entry.BoneTracked ? Entry.ComputeProxyCapsule(CapsuleBatch) : Entry.ComputeProxyCapsuleSimple(CapsuleBatch);
+			}
+
+			//Unshared shapes keep the hull until the commit, which rewrites the installed shape if it can
+			if (Entry.Prepared.HasConvexVerts && !Entry.Prepared.StoreVariant && BuildHull(Entry.Prepared.ConvexVerts, Entry.HasLayout ? &Entry.Layout : nullptr, Entry.Prepared.Hull)) {
+				Entry.Prepared.HasHull = true;
+				Stats::Frame.SpecializedHulls++;
+			} else if (Entry.Prepared.HasConvexVerts) {
+				Entry.Prepared.ConvexShape = BuildConvexShape(Entry.Prepared.ConvexVerts, Entry.HasLayout ? &Entry.Layout : nullptr);
+				if (Entry.Prepared.StoreVariant) {
+					Entry.StoreShapeVariant(Entry.Prepared.VariantKey, Entry.Prepared.ConvexShape);
+					if (Entry.ConvexWrapper) {
+						ShapeInternTable::GetSingleton()->Insert(Entry.Prepared.InternKey, Entry.Prepared.ConvexShape, Entry.ConvexWrapper.get(), Entry.Prepared.ConvexVerts.size());
+					}
+				}
+			}
+			if (Entry.Prepared.ConvexShape || Entry.Prepared.HasHull || Entry.Prepared.HasCapsules) {
+				CommitList.push_back(Id);
+			} else {
+				Entry.Prepared.World.reset();
+			}
+		}
+	});
+
+	CapsuleBatch.Run();
+	CommitPreparedShapes();
+
+	AdjustmentScheduler.ForEachDeferred([&](const Scheduler::Job& Job) {
+		Controllers[Job.Id].ScheduleAge++;
+	});
+
+	ShapeInternTable* InternTable = ShapeInternTable::GetSingleton();
+	if (++InternCollectFrame >= InternCollectInterval) {
+		InternCollectFrame = 0;
+		InternTable->Collect();
+		//Creatures that unloaded since leave idle clones behind
+		CreatureCloneCache::GetSingleton()->Trim();
+		//Pushed scales of actors that are gone for good
+		std::erase_if(ScaleOverrides, [](const auto& Entry) {
+			RE::ActorHandle Handle = Entry.first;
+			return !Handle.get();
+		});
+		ClearanceService::GetSingleton()->Collect(Stats::FrameIndex > InternCollectInterval ? Stats::FrameIndex - InternCollectInterval : 0);
+	}
+
+	Stats::Frame.CreatureClones = static_cast<uint32_t>(CreatureCloneCache::GetSingleton()->Size());
+	Stats::Frame.CreatureCloneBytes = CreatureCloneCache::GetSingleton()->Bytes();
+
+	if (Stats::WillLog()) {
+		std::vector<const hkpConvexVerticesShape*> ShapesInUse{};
+		ShapesInUse.reserve(Controllers.Size());
+		for (const ControllerData& Entry : Controllers) {
+			if (Entry.CommittedConvexShape) ShapesInUse.push_back(Entry.CommittedConvexShape);
+		}
+
+		const ShapeInternTable::SharingReport Report = InternTable->BuildReport(ShapesInUse);
+		Stats::Frame.InternedShapes = Report.Shapes;
+		Stats::Frame.InternUsers = Report.Users;
+		Stats::Frame.InternBytesSaved = Report.BytesSaved;
+	}
+
+	Stats::Frame.ScheduledJobs = static_cast<uint32_t>(AdjustmentScheduler.Size());
+	Stats::Frame.DeferredJobs = static_cast<uint32_t>(AdjustmentScheduler.Size() - Processed);
+	Stats::Frame.UpdateMicroseconds = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - UpdateStart).count();
+	ResolveStandClearance();
+	RefreshSneakClearance(Budget - std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - UpdateStart).count());
+
+	const ClearanceService::Counters ClearanceCounters = ClearanceService::GetSingleton()->TakeCounters();
+	Stats::Frame.ClearanceQueries = ClearanceCounters.Queries;
+	Stats::Frame.ClearanceCacheHits = ClearanceCounters.CacheHits;
+	Stats::Frame.ClearanceRays = ClearanceCounters.Rays;
+
+	PublishColliders();
+	Stats::EndFrame();
+}
+
+//Sneaking actors get their stand up clearance checked ahead of time, ProcessButton then finds a ready answer instead of casting.
+//Every actor is due fSneakClearanceHz times a second, due ones go through their own scheduler so a crowd of them gets spread
+//over a few frames and one batch is cast per frame under one world lock
+void AdjustmentHandler::RefreshSneakClearance(float BudgetMicroseconds) {
+	if (Settings::fSneakClearanceHz <= 0.f) return;
+
+	const auto Now = std::chrono::steady_clock::now();
+	const float Interval = 1.f / Settings::fSneakClearanceHz;
+	float Stalest = 0.f;
+
+	ClearanceScheduler.Clear();
+	for (size_t i = 0; i < Controllers.Size(); i++) {
+		ControllerData& Data = Controllers[i];
+		if (!Data.Sneaking || !Data.HasLayout) {
+			Data.ClearanceTime = {};
+			Data.ClearanceWait = 0;
+			continue;
+		}
+
+		//Never checked since it started sneaking, or the answer has gone stale
+		const bool Checked = Data.ClearanceTime != std::chrono::steady_clock::time_point{};
+		const float Age = Checked ? std::chrono::duration<float>(Now - Data.ClearanceTime).count() : Interval;
+		Stalest = std::max(Stalest, Age);
+
+		if (Age >= Interval) {
+			ClearanceScheduler.Push(static_cast<uint32_t>(i), Data.ScheduleTier, Data.CameraDistance, Data.ClearanceWait);
+		}
+	}
+
+	Stats::Frame.SneakClearanceHz = Settings::fSneakClearanceHz;
+	Stats::Frame.ClearanceStalestMilliseconds = Stalest * 1000.f;
+	if (ClearanceScheduler.Size() == 0) return;
+
+	ClearanceService* Clearance = ClearanceService::GetSingleton();
+	const size_t Refreshed = ClearanceScheduler.Run(std::max(BudgetMicroseconds, 0.f), MaxClearanceRefreshes, MaxClearanceRefreshes, [&](const Scheduler::Job* Jobs, size_t Count) {
+		ClearanceQueries.clear();
+		ClearanceTargets.clear();
+
+		for (size_t i = 0; i < Count; i++) {
+			ControllerData& Data = Controllers[Jobs[i].Id];
+			Data.ClearanceWait = 0;
+
+			NiPointer<Actor> NiActor = Data.ActorHandle.get();
+			if (!NiActor) continue;
+
+			ClearanceService::Query Query{};
+			if (!PrepareClearanceQuery(NiActor.get(), Query)) continue;
+			Query.Height = Data.CachedColliderHeight;
+			Query.Radius = Data.ColliderRadius;
+
+			ClearanceQueries.push_back(Query);
+			ClearanceTargets.push_back(Jobs[i].Id);
+		}
+
+		ClearanceResults.resize(ClearanceQueries.size());
+		Clearance->Resolve(ClearanceQueries, Stats::FrameIndex, ClearanceResults);
+
+		for (size_t i = 0; i < ClearanceTargets.size(); i++) {
+			ControllerData& Data = Controllers[ClearanceTargets[i]];
+			Data.Clearance = static_cast<uint8_t>(ClearanceResults[i].HasSpace ? DCA_API::Clearance::Clear : DCA_API::Clearance::Blocked);
+			Data.ClearanceFrame = Stats::FrameIndex;
+			Data.ClearanceTime = Now;
+		}
+	});
+
+	ClearanceScheduler.ForEachDeferred([&](const Scheduler::Job& Job) {
+		Controllers[Job.Id].ClearanceWait++;
+	});
+
+	Stats::Frame.ClearanceRefreshes = static_cast<uint32_t>(Refreshed);
+}
+
+//Scaled npc's that stood up or grew, the game doesn't check whether their new shape fits like it does for the player's sneak button.
+//Every held npc is checked once per frame in one batch that read locks each world once. Npc's that have not moved since their
+//last check reuse its answer, so a crowd stuck under a low ceiling only gets cast again every StandRecheckSeconds.
+//Growth is checked StandGrowthMargin bigger than the target, an npc that keeps growing then passes several frames on one check
+void AdjustmentHandler::ResolveStandClearance() {
+	ClearanceService* Clearance = ClearanceService::GetSingleton();
+	uint32_t Held = 0;
+
+	StandQueries.clear();
+	StandTargets.clear();
+	StandScales.clear();
+
+	const auto Apply = [](ControllerData& Data, const ClearanceService::Query& Query, float Scale, bool HasSpace) {
+		Data.Clearance = static_cast<uint8_t>(HasSpace ? DCA_API::Clearance::Clear : DCA_API::Clearance::Blocked);
+		Data.ClearanceFrame = Stats::FrameIndex;
+
+		if (HasSpace) {
+			Data.ClearedScale = Scale;
+			Data.ClearedOrigin = Query.Origin;
+			Data.ClearedTolerance = Query.Radius * ClearanceService::MoveToleranceFraction;
+			return 0u;
+		}
+
+		//Blocked with the headroom, it may still fit without
+		if (Scale > Data.HeldScale && Data.HeldScale > 0.f) Data.StandMarginBlocked = true;
+		return 1u;
+	};
+
+	for (size_t i = 0; i < Controllers.Size(); i++) {
+		ControllerData& Data = Controllers[i];
+		if (!Data.StandHeld && Data.HeldScale <= 0.f) continue;
+		//Far npc's are frozen anyway, they get checked once they are back in range
+		if (Data.ClearedScale > 0.f || Data.LOD == ControllerData::LODTier::kFar) continue;
+
+		NiPointer<Actor> NiActor = Data.ActorHandle.get();
+		if (!NiActor) continue;
+
+		ClearanceService::Query Query{};
+		if (!PrepareClearanceQuery(NiActor.get(), Query)) continue;
+
+		//The shape it is about to get, standing at its new scale
+		float Scale = Data.ActorScale;
+		if (Data.HeldScale > 0.f) {
+			Scale = Data.StandMarginBlocked ? Data.HeldScale : Data.HeldScale * (1.f + StandGrowthMargin);
+		}
+		Query.Height = ((Data.OriginalTop * 2.f) * Scale) + Data.OriginalBottom;
+		Query.Radius = Data.OriginalConvexRadius * Scale;
+
+		ClearanceService::Result Result{};
+		if (Clearance->FindCached(Query, Stats::FrameIndex, StandRecheckSeconds, Result)) {
+			Held += Apply(Data, Query, Scale, Result.HasSpace);
+			continue;
+		}
 
-	auto DrawCharController = [&](bhkCharacterController* Controller, ActorHandle Handle) {
+		StandQueries.push_back(Query);
+		StandTargets.push_back(static_cast<uint32_t>(i));
+		StandScales.push_back(Scale);
+	}
+
+	Stats::Frame.StandChecks = static_cast<uint32_t>(StandQueries.size());
+
+	if (!StandQueries.empty()) {
+		StandResults.resize(StandQueries.size());
+		Clearance->Resolve(StandQueries, Stats::FrameIndex, StandResults);
+
+		for (size_t i = 0; i < StandTargets.size(); i++) {
+			Held += Apply(Controllers[StandTargets[i]], StandQueries[i], StandScales[i], StandResults[i].HasSpace);
+		}
+	}
+
+	Stats::Frame.StandHeld = Held;
+}
+
+//Everything other plugins can read, copied out once per frame so they never need ControllersLock or the world lock
+void AdjustmentHandler::PublishColliders() {
+	const float ToGameUnits = *g_worldScaleInverse;
+	std::vector<ColliderEntry>& Staged = ColliderSnapshot.Stage();
+
+	for (ControllerData& Data : Controllers) {
+		if (!Data.CharController) continue;
+
+		ColliderEntry& Entry = Staged.emplace_back();
+		Entry.Key = Data.ActorHandle.native_handle();
+		Entry.Scale = Data.ActorScale;
+		Entry.Height = Data.CachedColliderHeight.quad.m128_f32[2] * ToGameUnits;
+		Entry.Radius = Data.ColliderRadius * ToGameUnits;
+		for (int i = 0; i < 3; i++) {
+			Entry.CapsuleA[i] = Data.ColliderCapsuleA.quad.m128_f32[i] * ToGameUnits;
+			Entry.CapsuleB[i] = Data.ColliderCapsuleB.quad.m128_f32[i] * ToGameUnits;
+		}
+		Entry.CapsuleRadius = Data.ColliderCapsuleRadius * ToGameUnits;
+		Entry.Clearance = Data.Clearance;
+		Entry.ClearanceFrame = Data.ClearanceFrame;
+	}
+
+	ColliderSnapshot.Publish(Stats::FrameIndex);
+}
+
+bool AdjustmentHandler::FindCollider(uint32_t ActorHandle, ColliderEntry& OutEntry, uint64_t& OutFrame) {
+	return ColliderSnapshot.Find(ActorHandle, OutEntry, OutFrame);
+}
+
+//Updates the controller's scale and dirty state, returns true if any of its shapes need to be rebuilt
+bool AdjustmentHandler::CharacterControllerUpdate(ControllerData& Data, const NiPoint3& CameraPosition) {
+	if (!Settings::bEnableActorScaleFix) return false;
+	if (!Data.CharController) return false;
+
+	NiPointer<Actor> NiActor = Data.ActorHandle.get();
+	if (!NiActor) return false;
+	if (NiActor->IsDead()) return false;
+
+	Actor* ActorPtr = NiActor.get();
+	if (!ActorPtr) return false;
+
+	Stats::Frame.Controllers++;
+
+	if (Data.SettingsVersion != Settings::uSettingsVersion) {
+		Data.SettingsVersion = Settings::uSettingsVersion;
+		Data.Dirty |= ControllerData::kDirtySettings;
+	}
+
+	const bool IsPlayer = ActorPtr->formID == 0x14;
+	const bool IsFollower = !IsPlayer && ActorPtr->IsPlayerTeammate();
+	Data.ScheduleTier = IsPlayer ? Scheduler::Tier::kPlayer : IsFollower ? Scheduler::Tier::kFollower : Scheduler::Tier::kNPC;
+	Data.CameraDistance = ActorPtr->GetPosition().GetDistance(CameraPosition);
+
+	//The Player And Followers Get Realtime ConvexShape Update Based On Bone Position, npc's depend on how far away they are
+	const ControllerData::LODTier PreviousLOD = Data.LOD;
+	Data.LOD = (IsPlayer || IsFollower) ? ControllerData::LODTier::kNear : Data.SelectLOD(Data.CameraDistance);
+	Data.BoneTracked = Data.LOD == ControllerData::LODTier::kNear;
+
+	//Switching between bone tracked and scale only shapes needs a full rebuild
+	if (PreviousLOD != Data.LOD && (PreviousLOD == ControllerData::LODTier::kNear || Data.BoneTracked)) {
+		Data.Dirty |= ControllerData::kDirtyAll;
+	}
+
+	//Controllers registered after their actor's scale got pushed pick it up here
+	if (!Data.PushedScaleChecked) {
+		Data.PushedScaleChecked = true;
+		const auto Search = ScaleOverrides.find(Data.ActorHandle);
+		Data.PushedScale = Search != ScaleOverrides.end() ? Search->second : 0.f;
+	}
+
+	//Pushed scales replace the scale nodes, the skeleton is then only read for bone tracked shapes
+	const bool ScalePushed = Data.PushedScale > 0.f;
+
+	//3D resets and reloads swap the roots out, the cache looks everything up again when that happens
+	if (!ScalePushed || Data.BoneTracked) {
+		Data.Bones.Refresh(ActorPtr);
+	}
+	Data.Pose = Data.Bones.Sample(ActorPtr, Data.BoneTracked, !ScalePushed);
+
+	if (ScalePushed) {
+		Data.Pose.Scale = Data.PushedScale;
+		Stats::Frame.PushedScales++;
+	}
+
+	if (!Utils::FloatsEqual(Data.Pose.Scale, Data.ActorScale)) {
+		Data.Dirty |= ControllerData::kDirtyScale;
+	}
+
+	//Update Scale, scaled npc's standing up or growing wait for room first. Bone tracked shapes follow the skeleton instead
+	const bool CanHold = Settings::bNPCStandClearance && !Data.BoneTracked && !Data.IsCreature && Data.HasLayout;
+	Data.ActorScale = Data.HoldForClearance(CanHold);
+
+	if (Data.BoneTracked && Data.SamplePose()) {
+		Data.Dirty |= ControllerData::kDirtyPose;
+	}
+
+	if (!IsPlayer && !IsFollower) {
+		//Creatures are skipped, Im too dumb to fix them
+		//Their shape only gets swapped for a scaled clone
+		if (Data.IsCreature) {
+			if (Settings::bEnableCreatureScaling && (Data.Dirty & ControllerData::kDirtyScale)) {
+				Data.AdjustProxyCapsuleCreature_Hack();
+			}
+			Data.Dirty = ControllerData::kDirtyNone;
+			return false;
+		}
+
+		//Non Creatures NPC's Only start getting adjusted once their scale changed
+		if (!Data.HasAdjustedShape) {
+			Data.Dirty &= ControllerData::kDirtyScale;
+		}
+	}
+
+	//Far away npc's keep their dirty bits, the shape gets rebuilt once they are back in range
+	if (Data.LOD == ControllerData::LODTier::kFar) {
+		Stats::Frame.FrozenControllers++;
+		return false;
+	}
+
+	if (Data.Dirty == ControllerData::kDirtyNone) {
+		Stats::Frame.SkippedRebuilds += 2;
+		return false;
+	}
+
+	return true;
+}
+
+//Main thread part of the compute phase, takes the dirty bits and everything the shape math needs from the game
+bool AdjustmentHandler::PrepareControllerShapes(ControllerData& Data) {
+	uint8_t Pending = Data.Dirty;
+	Data.Dirty = ControllerData::kDirtyNone;
+
+	NiPointer<Actor> NiActor = Data.ActorHandle.get();
+	if (!NiActor) return false;
+
+	TESObjectCELL* Cell = NiActor->GetParentCell();
+	if (!Cell) return false;
+
+	NiPointer<bhkWorld> World = NiPointer(Cell->GetbhkWorld());
+	if (!World) return false;
+
+	if (Pending & ControllerData::ConvexShapeDirtyMask) {
+		Stats::Frame.ConvexRebuilds++;
+	} else {
+		Stats::Frame.SkippedRebuilds++;
+	}
+
+	if (Pending & ControllerData::CapsuleDirtyMask) {
+		Stats::Frame.CapsuleRebuilds++;
+	} else {
+		Stats::Frame.SkippedRebuilds++;
+	}
+
+	if (Data.ScheduleTier == Scheduler::Tier::kNPC) {
+		Data.HasAdjustedShape = true;
+	}
+
+	if (Pending & ControllerData::kDirtySettings) {
+		Data.ClearShapeVariants();
+	}
+
+	//Sneak and swim transitions of scale only shapes usually have their hull built already, that makes them a pointer swap
+	Data.Prepared.StoreVariant = false;
+	if ((Pending & ControllerData::ConvexShapeDirtyMask) && !Data.BoneTracked && Settings::bEnableStateAdjustments) {
+		const uint32_t Key = Data.ShapeVariantKey();
+		hkpConvexVerticesShape* Cached = Data.FindShapeVariant(Key);
+
+		//Another actor with the same shape and scale may have built it already
+		if (!Cached && Data.ConvexWrapper) {
+			Data.Prepared.InternKey = Data.ShapeInternKey();
+			Cached = ShapeInternTable::GetSingleton()->Find(Data.Prepared.InternKey);
+			if (Cached) {
+				Data.StoreShapeVariant(Key, Cached);
+				Stats::Frame.InternHits++;
+			}
+		}
+
+		if (Cached) {
+			Cached->AddReference();  //The commit hands this reference over to havok
+			Data.Prepared.ConvexShape = Cached;
+			Pending &= ~ControllerData::ConvexShapeDirtyMask;
+			Stats::Frame.ShapeCacheHits++;
+		} else {
+			Data.Prepared.VariantKey = Key;
+			Data.Prepared.StoreVariant = true;
+			Stats::Frame.ShapeCacheMisses++;
+		}
+	}
+
+	Data.Prepared.Pending = Pending;
+	Data.Prepared.World = World;
+	return true;
+}
+
+//Worker part of the compute phase, pure math on the controller's own data
+void AdjustmentHandler::ComputeControllerShapes(ControllerData& Data) {
+	const uint8_t Pending = Data.Prepared.Pending;
+
+	if (Pending & ControllerData::ConvexShapeDirtyMask) {
+		Data.Prepared.HasConvexVerts = Data.BoneTracked ? Data.ComputeConvexShape() : Data.ComputeConvexShapeSimple();
+	}
+}
+
+//Commit phase, takes every world's write lock once and swaps in all the shapes prepared for it this frame
+void AdjustmentHandler::CommitPreparedShapes() {
+	if (CommitList.empty()) return;
+
+	std::sort(CommitList.begin(), CommitList.end(), [](uint32_t A, uint32_t B) {
+		return Controllers[A].Prepared.World.get() < Controllers[B].Prepared.World.get();
+	});
+
+	for (size_t i = 0; i < CommitList.size();) {
+		bhkWorld* World = Controllers[CommitList[i]].Prepared.World.get();
+
+		size_t End = i;
+		while (End < CommitList.size() && Controllers[CommitList[End]].Prepared.World.get() == World) {
+			End++;
+		}
+
+		{
+			BSWriteLockGuard lock(World->worldLock);
+			const auto LockStart = std::chrono::steady_clock::now();
+
+			for (size_t j = i; j < End; j++) {
+				Controllers[CommitList[j]].CommitShapes();
+			}
+
+			Stats::Frame.WorldLockMicroseconds += std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - LockStart).count();
+			Stats::Frame.WorldLocks++;
+		}
+
+		i = End;
+	}
+
+	CommitList.clear();
+}
+
+//-----------------------
+//	Debug Draw
+//-----------------------
+
+void DrawLine(hkVector4& Start, hkVector4& End, NiPoint3& ControllerPosition) {
+	NiPoint3 S = Utils::HkVectorToNiPoint(Start) * *g_worldScaleInverse;
+	NiPoint3 E = Utils::HkVectorToNiPoint(End) * *g_worldScaleInverse;
+	S += ControllerPosition;
+	E += ControllerPosition;
+	Settings::g_trueHUD->DrawLine(S, E, 0.f, 0x00FF00FF,2);
+}
+
+void AdjustmentHandler::DebugDraw() {
+	TRUEHUD_API::IVTrueHUD4* TrueHUD = Settings::g_trueHUD;
+	if (!TrueHUD || Settings::uDisplayDebugShapes == DebugDrawMode::kNone) return;
+
+	if (UI::GetSingleton()->GameIsPaused()) return;
+
+	auto DrawCharController = [&](bhkCharacterController* Controller, ActorHandle Handle, ControllerData* Data) {
 		if (!Controller) return;
 
 		NiPointer<Actor> NiActor = Handle.get();
@@ -1388,7 +2258,7 @@ void AdjustmentHandler::DebugDraw() {
 		if (NiActor->IsDead()) return;
 
 		const hkpConvexVerticesShape* CollisionConvexVertexShape = nullptr;
-		std::vector<hkpCapsuleShape*> CollisionCapsules{};
+		CapsuleList CollisionCapsules{};
 
 		TESObjectCELL* Cell = NiActor->GetParentCell();
 		if (!Cell) return;
@@ -1398,7 +2268,14 @@ void AdjustmentHandler::DebugDraw() {
 
 		{
 			BSReadLockGuard WorldLock(World->worldLock);
-			GetShapes(Controller, CollisionConvexVertexShape, CollisionCapsules);
+			//Registered controllers already know where their shapes are
+			if (Data) {
+				const ControllerData::ShapeLookup& Lookup = Data->LookupShapes();
+				CollisionConvexVertexShape = Lookup.ConvexShape;
+				CollisionCapsules = Lookup.Capsules;
+			} else {
+				GetShapes(Controller, CollisionConvexVertexShape, CollisionCapsules);
+			}
 		}
 
 		hkVector4 ControllerPosition;
@@ -1406,49 +2283,27 @@ void AdjustmentHandler::DebugDraw() {
 		NiPoint3 ContollerNiPosition = Utils::HkVectorToNiPoint(ControllerPosition) * *g_worldScaleInverse;
 
 		if (CollisionConvexVertexShape) {
-			// The charcontroller shape is composed of two vertically concentric "rings" with a single point above and below the top/bottom ring.
-			// verts 0,2,6,10,12,14,15,17 are bottom ring, 8-9 are bottom/top points, 1,3,4,5,7,11,13,16 are top ring
+			// The charcontroller shape is composed of two vertically concentric "rings", usually with a single point above and below the top/bottom ring.
 			hkArray<hkVector4> Verts{};
 			hkpConvexVerticesShape_getOriginalVertices(CollisionConvexVertexShape, Verts);
 
-			if (Verts.size() == 18) {
-				// draw top ring of verts
-				std::vector topRing = { 1, 4, 13, 7, 3, 16, 5, 11, 1 };
-				for (std::vector<int>::iterator Itter = topRing.begin(); Itter != topRing.end() - 1; ++Itter) {
-					DrawLine(Verts[*Itter], Verts[*(Itter + 1)], ContollerNiPosition);
-				}
-
-				// draw bottom ring of verts
-				std::vector bottomRing = { 0, 2, 12, 6, 15, 17, 14, 10, 0 };
-				for (std::vector<int>::iterator Itter = bottomRing.begin(); Itter != bottomRing.end() - 1; ++Itter) {
-					DrawLine(Verts[*Itter], Verts[*(Itter + 1)], ContollerNiPosition);
-				}
-
-				// draw vertical lines
-				std::vector pairs = { 1, 0, 4, 2, 13, 12, 7, 6, 3, 15, 16, 17, 5, 14, 11, 10, 9, 1, 9, 4, 9, 13, 9, 7, 9, 3, 9, 16, 9, 5, 9, 11, 8, 0, 8, 2, 8, 12, 8, 6, 8, 15, 8, 17, 8, 14, 8, 10, 0, 0 };
-				for (std::vector<int>::iterator Itter = pairs.begin(); Itter != pairs.end() - 2;) {
-					DrawLine(Verts[*Itter], Verts[*(Itter + 1)], ContollerNiPosition);
-					Itter += 2;
-				}
-			}
-			else if (Verts.size() == 17) {  // very short - no top vert. 8 is bottom
-				// draw top ring of verts
-				std::vector topRing = { 1, 4, 12, 7, 3, 15, 5, 10, 1 };
-				for (std::vector<int>::iterator Itter = topRing.begin(); Itter != topRing.end() - 1; ++Itter) {
-					DrawLine(Verts[*Itter], Verts[*(Itter + 1)], ContollerNiPosition);
-				}
+			ControllerHull::Topology Layout{};
+			if (ControllerHull::Resolve(reinterpret_cast<const ControllerHull::Vector*>(Verts.data()), Verts.size(), Layout)) {
+				for (size_t i = 0; i < Layout.RingSize; i++) {
+					const size_t Next = (i + 1) % Layout.RingSize;
 
-				// draw bottom ring of verts
-				std::vector bottomRing = { 0, 2, 11, 6, 14, 16, 13, 9, 0 };
-				for (std::vector<int>::iterator Itter = bottomRing.begin(); Itter != bottomRing.end() - 1; ++Itter) {
-					DrawLine(Verts[*Itter], Verts[*(Itter + 1)], ContollerNiPosition);
-				}
+					// draw the rings and the vertical lines between them
+					DrawLine(Verts[Layout.TopRing[i]], Verts[Layout.TopRing[Next]], ContollerNiPosition);
+					DrawLine(Verts[Layout.BottomRing[i]], Verts[Layout.BottomRing[Next]], ContollerNiPosition);
+					DrawLine(Verts[Layout.TopRing[i]], Verts[Layout.BottomRing[i]], ContollerNiPosition);
 
-				// draw vertical lines
-				std::vector pairs = { 1, 0, 4, 2, 12, 11, 7, 6, 3, 14, 15, 16, 5, 13, 10, 9, 8, 0, 8, 2, 8, 11, 8, 6, 8, 14, 8, 16, 8, 13, 8, 9, 0, 0 };
-				for (std::vector<int>::iterator Itter = pairs.begin(); Itter != pairs.end() - 2;) {
-					DrawLine(Verts[*Itter], Verts[*(Itter + 1)], ContollerNiPosition);
-					Itter += 2;
+					// and the top/bottom points to their ring
+					if (Layout.TopApex != ControllerHull::NoApex) {
+						DrawLine(Verts[Layout.TopApex], Verts[Layout.TopRing[i]], ContollerNiPosition);
+					}
+					if (Layout.BottomApex != ControllerHull::NoApex) {
+						DrawLine(Verts[Layout.BottomApex], Verts[Layout.BottomRing[i]], ContollerNiPosition);
+					}
 				}
 			}
 		}
@@ -1493,8 +2348,8 @@ void AdjustmentHandler::DebugDraw() {
 		}
 
 		case DebugDrawMode::kAdjusted: {
-			ForEachController([&](std::shared_ptr<ControllerData> Entry) {
-				DrawCharController(Entry->CharController, Entry->ActorHandle);
+			ForEachController([&](ControllerData& Entry) {
+				DrawCharController(Entry.CharController, Entry.ActorHandle, &Entry);
 			});
 			break;
 		}
@@ -1502,12 +2357,12 @@ void AdjustmentHandler::DebugDraw() {
 		case DebugDrawMode::kAll: {
 			ActorHandle PlayerHandle = PlayerCharacter::GetSingleton()->GetHandle();
 			bhkCharacterController* PlayerController = PlayerCharacter::GetSingleton()->GetCharController();
-			DrawCharController(PlayerController, PlayerHandle);
+			DrawCharController(PlayerController, PlayerHandle, nullptr);
 
 			for (ActorHandle& ActorHandle : ProcessLists::GetSingleton()->highActorHandles) {
 				if (NiPointer<Actor> NiActor = ActorHandle.get()) {
 					if (bhkCharacterController* Controller = NiActor->GetCharController()) {
-						DrawCharController(Controller, ActorHandle);
+						DrawCharController(Controller, ActorHandle, nullptr);
 					}
 				}
 			}
@@ -1520,47 +2375,63 @@ void AdjustmentHandler::DebugDraw() {
 //	Misc
 //-----------------------
 
-bool AdjustmentHandler::CheckEnoughSpaceToStand(ActorHandle ActorHandle) {
-	NiPointer<Actor> NiActor = ActorHandle.get();
-	if (!NiActor) return true;
-
-	TESObjectCELL* Cell = NiActor->parentCell;
-	if (!Cell) return true;
+//Everything a clearance query needs except the collider, the caller fills that in from the controller's data
+bool AdjustmentHandler::PrepareClearanceQuery(Actor* ActorPtr, ClearanceService::Query& OutQuery) {
+	TESObjectCELL* Cell = ActorPtr->parentCell;
+	if (!Cell) return false;
 
 	bhkWorld* World = Cell->GetbhkWorld();
-	if (!World) return true;
-
-	bhkCharacterController* CharController = NiActor->GetCharController();
-	if (!CharController) return true;
-
-	std::shared_ptr<ControllerData> ControllerData = GetControllerData(ActorHandle);
-	if (!ControllerData) return true;
-	if (ControllerData->OriginalVerts.size() != 18) return true;
+	if (!World) return false;
 
-	hkVector4 ControllerPos, RayStart, RayEnd;
-	CharController->GetPosition(ControllerPos, false);
+	bhkCharacterController* CharController = ActorPtr->GetCharController();
+	if (!CharController) return false;
 
-	RayStart = ControllerPos;
-	RayEnd = RayStart + ControllerData->CachedColliderHeight;
-
-	hkpWorldRayCastInput RaycastInput;
-	hkpWorldRayCastOutput RaycastOutput;
+	OutQuery.World = World;
+	OutQuery.Controller = CharController;
+	CharController->GetPosition(OutQuery.Origin, false);
 
 	uint32_t ColisionfilterInfo = 0;
-	NiActor->GetCollisionFilterInfo(ColisionfilterInfo);
+	ActorPtr->GetCollisionFilterInfo(ColisionfilterInfo);
 	uint16_t ColisionGroup = ColisionfilterInfo >> 16;
-	RaycastInput.filterInfo = static_cast<uint32_t>(ColisionGroup) << 16 | static_cast<uint32_t>(COL_LAYER::kCharController);
-	RaycastInput.from = RayStart;
-	RaycastInput.to = RayEnd;
+	OutQuery.FilterInfo = static_cast<uint32_t>(ColisionGroup) << 16 | static_cast<uint32_t>(COL_LAYER::kCharController);
+	return true;
+}
+
+bool AdjustmentHandler::CheckEnoughSpaceToStand(ActorHandle ActorHandle) {
+	NiPointer<Actor> NiActor = ActorHandle.get();
+	if (!NiActor) return true;
+
+	ClearanceService::Query Query{};
+	if (!PrepareClearanceQuery(NiActor.get(), Query)) return true;
 
 	{
-		BSReadLockGuard lock(World->worldLock);
-		World->GetWorld1()->CastRay(RaycastInput, RaycastOutput);
+		ReadLocker locker(ControllersLock);
+
+		ControllerData* Data = GetControllerData(Query.Controller);
+		if (!Data) return true;
+		if (!Data->HasLayout) return true;
+
+		Query.Height = Data->CachedColliderHeight;
+		Query.Radius = Data->ColliderRadius;
 	}
 
-	if (RaycastOutput.HasHit()) {
+	//Sneaking actors get their clearance refreshed in the background, usually the answer is already there.
+	//A refresh that runs a frame late still counts, anything older gets cast again
+	ClearanceService* Clearance = ClearanceService::GetSingleton();
+	ClearanceService::Result Result{};
+	const float MaxAge = Settings::fSneakClearanceHz > 0.f ? 1.5f / Settings::fSneakClearanceHz : 0.f;
+	if (Clearance->FindCached(Query, Stats::FrameIndex, MaxAge, Result)) return Result.HasSpace;
+
+	Clearance->Resolve({ &Query, 1 }, Stats::FrameIndex, { &Result, 1 });
+
+	//Published with the next collider snapshot
+	ControllerEvent Event{ Query.Controller, ControllerEvent::Type::kClearance };
+	Event.HasSpace = Result.HasSpace;
+	QueueControllerEvent(Event);
+
+	if (!Result.HasSpace) {
 		if (Settings::g_trueHUD && Settings::uDisplayDebugShapes != DebugDrawMode::kNone) {
-			Settings::g_trueHUD->DrawArrow(Utils::HkVectorToNiPoint(RayStart, true), Utils::HkVectorToNiPoint(RayEnd, true), 10.f, 1.f);
+			Settings::g_trueHUD->DrawArrow(Utils::HkVectorToNiPoint(Result.BlockedFrom, true), Utils::HkVectorToNiPoint(Result.BlockedTo, true), 10.f, 1.f);
 		}
 		return false;
 	}
@@ -1574,12 +2445,27 @@ bool AdjustmentHandler::CheckEnoughSpaceToStand(ActorHandle ActorHandle) {
 
 void AdjustmentHandler::AddControllerToMap(bhkCharacterController* Controller, ActorHandle Handle) {
 	WriteLocker lock(ControllersLock);
-	ControllerMap.emplace(Controller, std::make_shared<ControllerData>(Controller, Handle));
+	if (ControllerHandles.contains(Controller)) return;
+
+	ControllerHandles.emplace(Controller, Controllers.Emplace(Controller, Handle));
 }
 
+//Called from the controller's destructor on whatever thread the game frees it on. The data still holds havok shapes and
+//havok's heap is per thread, so the slot is only marked dead here and gets erased on the main thread when the queue is drained
 void AdjustmentHandler::RemoveControllerFromMap(bhkCharacterController* Controller) {
 	WriteLocker lock(ControllersLock);
-	ControllerMap.erase(Controller);
+	if (auto Search = ControllerHandles.find(Controller); Search != ControllerHandles.end()) {
+		if (ControllerData* Data = Controllers.Get(Search->second)) {
+			Data->CharController = nullptr;
+		}
+
+		ControllerEvent Event{ Controller, ControllerEvent::Type::kRemoved };
+		Event.Removed = Search->second;
+		QueueControllerEvent(Event);
+		ControllerHandles.erase(Search);
+	}
+
+	ClearanceService::GetSingleton()->Forget(Controller);
 }
 
 //-----------------------
@@ -1,13 +1,33 @@
 #pragma once
 
+#include "BoneCache.h"
+#include "CapsuleKernel.h"
+#include "ClearanceService.h"
+#include "ControllerHull.h"
+#include "CreatureCloneCache.h"
+#include "DynamicCollisionAdjustmentAPI.h"
+#include "EventQueue.h"
+#include "RingKernel.h"
 #include "Havok.h"
+#include "Scheduler.h"
+#include "ShapeIntern.h"
+#include "ShapeVisitor.h"
+#include "SlotMap.h"
+#include "SnapshotTable.h"
 
+#include <mutex>
 #include <shared_mutex>
 
 class AdjustmentHandler {
 
 	public:
 
+	using Scheduler = FrameScheduler<uint32_t>;
+
+	//Plenty for every controller in the game, creatures included
+	static constexpr size_t MaxControllerCapsules = 16;
+	using CapsuleList = ShapeVisitor::InlineBuffer<RE::hkpCapsuleShape*, MaxControllerCapsules>;
+
 	struct ControllerData {
 		ControllerData(RE::bhkCharacterController* Controller, RE::ActorHandle& Handle) : CharController(Controller), ActorHandle(Handle) {
 			Initialize();
@@ -15,13 +35,107 @@ class AdjustmentHandler {
 		}
 
 		void Initialize();
-		void AdjustProxyCapsule();
-		void AdjustProxyCapsuleSimple();
+		bool ComputeProxyCapsule(CapsuleKernel::Batch& Batch);
+		bool ComputeProxyCapsuleSimple(CapsuleKernel::Batch& Batch);
 		void AdjustProxyCapsuleCreature();
 		void AdjustProxyCapsuleCreature_Hack();
-		void AdjustConvexShape();
-		void AdjustConvexShapeSimple();
+		bool ComputeConvexShape();
+		bool ComputeConvexShapeSimple();
+		void CommitShapes();
+		bool RewriteCommittedShape();
 		void SetupProxyCapsule();
+		bool SamplePose();
+
+		//Scaled npc's standing up or growing keep their current shape until there is room for the new one.
+		//Returns the scale the shape gets built with this frame
+		float HoldForClearance(bool CanHold);
+		[[nodiscard]] bool ShapeSneaking() const { return Sneaking || StandHeld; }
+
+		//Scale only convex shapes, one per quantized scale and movement state
+		uint32_t ShapeVariantKey() const;
+		ShapeInternTable::Key ShapeInternKey() const;
+		RE::hkpConvexVerticesShape* FindShapeVariant(uint32_t Key);
+		void StoreShapeVariant(uint32_t Key, RE::hkpConvexVerticesShape* Shape);
+		void ClearShapeVariants();
+
+		//How much effort goes into an npc's shape, picked by distance
+		enum class LODTier : uint8_t {
+			kNear,  //Bone tracked, same as the player and followers
+			kMid,   //Scale only
+			kFar    //Frozen at the last built shape
+		};
+
+		LODTier SelectLOD(float Distance) const;
+
+		//What changed since the shapes were last rebuilt
+		enum DirtyFlags : uint8_t {
+			kDirtyNone = 0,
+			kDirtyScale = 1 << 0,
+			kDirtySneak = 1 << 1,
+			kDirtyCharacterState = 1 << 2,
+			kDirtyPose = 1 << 3,
+			kDirtySettings = 1 << 4,
+			kDirtyAll = kDirtyScale | kDirtySneak | kDirtyCharacterState | kDirtyPose | kDirtySettings
+		};
+
+		//Which changes require which part to be rebuilt, the capsules don't care about sneak or character state
+		static constexpr uint8_t ConvexShapeDirtyMask = kDirtyAll;
+		static constexpr uint8_t CapsuleDirtyMask = kDirtyScale | kDirtyPose | kDirtySettings;
+
+		//Bone movement (in havok units) smaller than this is not considered a new pose
+		static constexpr float PoseTolerance = 0.002f;
+
+		//Scales closer than this share a cached shape variant
+		static constexpr float ShapeVariantScaleStep = 0.01f;
+		static constexpr size_t MaxShapeVariants = 4;
+
+		//A cached hull, the entry holds its own reference so the shape outlives being swapped out of havok
+		struct ShapeVariant {
+			uint32_t Key = 0;
+			uint32_t LastUse = 0;
+			RE::hkRefPtr<RE::hkpConvexVerticesShape> Shape{};
+		};
+
+		//Where the controller's shapes live in havok. The shape tree is walked once and reused until the controller's
+		//shapes[] or the collidable's top level shape change, the wrappers are held so their addresses can't be reused meanwhile
+		struct ShapeLookup {
+			std::array<RE::NiPointer<RE::bhkShape>, 2> Owners{};
+			const RE::hkpShape* Collidable = nullptr;
+
+			bool IsRigidBodyController = false;
+			RE::hkpCharacterProxy* Proxy = nullptr;
+			RE::hkpCharacterRigidBody* RigidBody = nullptr;
+			RE::hkpListShape* ListShape = nullptr;
+			RE::hkpConvexVerticesShape* ConvexShape = nullptr;
+			CapsuleList Capsules{};
+			bool Valid = false;
+
+			[[nodiscard]] bool HasConvexShape() const { return ListShape && ConvexShape; }
+		};
+
+		//Main thread, under the world lock
+		ShapeLookup& LookupShapes();
+
+		//Output of the compute phase, swapped into havok during the commit phase
+		struct PreparedShapes {
+			RE::NiPointer<RE::bhkWorld> World = nullptr;
+			RE::hkpConvexVerticesShape* ConvexShape = nullptr;  //Built with a refcount of 1, the commit hands that reference over to havok
+			std::vector<RE::hkVector4> ConvexVerts{};           //Scratch, kept around so it does not reallocate every rebuild
+			uint32_t CapsuleOffset = 0;  //This controller's capsules in the frame's CapsuleBatch
+			uint32_t CapsuleCount = 0;
+			uint8_t Pending = 0;  //Dirty bits this rebuild handles
+			uint32_t VariantKey = 0;
+			ShapeInternTable::Key InternKey{};
+			bool StoreVariant = false;  //Built shape goes into the variant cache
+			ControllerHull::Result Hull{};  //Specialized hull, turned into a shape (or rewritten into the current one) during the commit
+			bool HasHull = false;
+			bool HasConvexVerts = false;
+			RE::hkVector4 ColliderHeight{};  //Extents the workers computed with the verts, the commit copies them into CachedColliderHeight and ColliderRadius
+			float ColliderRadius = 0.f;
+			bool HasColliderSize = false;
+			bool HasCapsules = false;
+			bool RigidBodyCapsulesOnly = false;
+		};
 
 		RE::bhkCharacterController* CharController;
 		RE::ActorHandle ActorHandle;
@@ -32,23 +146,84 @@ class AdjustmentHandler {
 		//Calculated Scale (GTS)
 		float ActorScale = 1.f;
 		float OldActorScale = 1.f;
+		float PushedScale = 0.f;  //From the api, 0 while the scale gets read from the actor's nodes
+		bool PushedScaleChecked = false;
 
 		bool Sneaking = false;
 		bool IsInitialized = false;
 
 		RE::NiPointer<RE::bhkShape> bhkClone = nullptr;
+		RE::NiPointer<RE::bhkShape> CreatureSource = nullptr;  //The creature's own shape, every scaled clone is made from it
 		RE::hkpCharacterStateType CharacterState = RE::hkpCharacterStateType::kOnGround;
 
 		//ConvexShape
 		float OriginalConvexRadius;
 		bool IsCreature;
 		std::vector<RE::hkVector4> OriginalVerts{};
+		uint64_t OriginalVertsHash = 0;
+		//Which vertices are the apexes and rings, worked out once so every adjust path can handle any hull layout
+		ControllerHull::Topology Layout{};
+		bool HasLayout = false;
+		RE::hkVector4 OriginalTop;     //Top apex, or the top ring's center for hulls without one
+		RE::hkVector4 OriginalBottom;  //Same for the bottom
+		RE::NiPointer<RE::bhkShape> ConvexWrapper = nullptr;  //Wrapper of the original shape, shared shapes can't be trusted to point back at it
+		const RE::hkpConvexVerticesShape* CommittedConvexShape = nullptr;  //Identity only, for the sharing report
 
 		//CapsuleShape
 		std::vector<float> OriginalCapsuleRadius{};
 		std::vector<RE::hkVector4> OriginalCapsuleA{};
 		std::vector<RE::hkVector4> OriginalCapsuleB{};
-		RE::hkVector4 CachedColliderHeight;
+		RE::hkVector4 CachedColliderHeight;  //Standing height at the current scale, relative to the controller
+
+		//Last computed extents, what the collider snapshot publishes
+		float ColliderRadius = 0.f;
+		RE::hkVector4 ColliderCapsuleA{};  //Main capsule
+		RE::hkVector4 ColliderCapsuleB{};
+		float ColliderCapsuleRadius = 0.f;
+
+		//Last stand clearance check
+		uint8_t Clearance = 0;  //DCA_API::Clearance
+		uint64_t ClearanceFrame = 0;
+		std::chrono::steady_clock::time_point ClearanceTime{};
+		uint32_t ClearanceWait = 0;  //Frames a due background refresh has been deferred
+
+		//Shape changes held back until ResolveStandClearance finds room for them
+		bool StandHeld = false;           //Stood up, the shape is still the sneaking one
+		float HeldScale = 0.f;            //Grew to this scale, the shape is still at ActorScale. 0 if not held
+		bool StandMarginBlocked = false;  //The check with growth headroom was blocked, the next one checks HeldScale itself
+
+		//Last check that found room, it covers standing up and growing as long as the npc stays below ClearedScale and near ClearedOrigin
+		float ClearedScale = 0.f;  //0 if there is none
+		RE::hkVector4 ClearedOrigin{};
+		float ClearedTolerance = 0.f;  //How far the npc may move from ClearedOrigin, havok units
+
+		//Dirty Tracking
+		//Scale is left out on purpose, unscaled npc's should keep their original shape until they actually get scaled
+		uint8_t Dirty = kDirtyAll & ~kDirtyScale;
+		uint32_t SettingsVersion = 0;
+		bool HasAdjustedShape = false;
+
+		//Bone nodes, resolved whenever the actor's 3D changes
+		BoneCache Bones{};
+		PoseSnapshot Pose{};  //This frame's, every adjust path reads the skeleton through it
+
+		//Bone positions the bone tracked shapes were last built from
+		RE::hkVector4 PoseHead{};
+		float PoseClavicleZ = 0.f;
+		float PoseCalfZ = 0.f;
+
+		//Scheduling
+		LODTier LOD = LODTier::kMid;
+		bool BoneTracked = false;
+		Scheduler::Tier ScheduleTier = Scheduler::Tier::kNPC;
+		float CameraDistance = 0.f;
+		uint32_t ScheduleAge = 0;  //Frames this controller's pending work has been deferred
+
+		PreparedShapes Prepared{};
+		ShapeLookup Shapes{};
+
+		std::array<ShapeVariant, MaxShapeVariants> ShapeVariants{};
+		uint32_t ShapeVariantClock = 0;
 	};
 
 	static AdjustmentHandler* GetSingleton() {
@@ -56,9 +231,49 @@ class AdjustmentHandler {
 		return std::addressof(Singleton);
 	}
 
-	void ActorSneakStateChanged(RE::ActorHandle ActorHandle, bool Sneaking);
+	//State events come in from the havok/actor threads, they are queued and applied once per frame in Update
+	struct ControllerEvent {
+		enum class Type : uint8_t {
+			kSneak,
+			kCharacterState,
+			kClearance,
+			kRemoved  //The controller was destroyed, its slot gets erased and nothing queued before this applies to the address anymore
+		};
+
+		RE::bhkCharacterController* Controller = nullptr;
+		Type EventType = Type::kSneak;
+		bool Sneaking = false;
+		RE::hkpCharacterStateType CharacterState = RE::hkpCharacterStateType::kOnGround;
+		bool HasSpace = true;
+		SlotMap<ControllerData>::Handle Removed{};
+	};
+
+	//Published copy of one controller's collider, in game units and relative to the actor
+	struct ColliderEntry {
+		uint32_t Key = 0;  //Native actor handle
+		float Scale = 1.f;
+		float Height = 0.f;
+		float Radius = 0.f;
+		float CapsuleA[3]{};
+		float CapsuleB[3]{};
+		float CapsuleRadius = 0.f;
+		uint8_t Clearance = 0;
+		uint64_t ClearanceFrame = 0;
+	};
+
+	//Reads the snapshot published at the end of the last frame, any thread and without a lock
+	static bool FindCollider(uint32_t ActorHandle, ColliderEntry& OutEntry, uint64_t& OutFrame);
+
+	void ActorSneakStateChanged(RE::Actor* ActorPtr, bool Sneaking);
+	//Scales pushed through the api come in from any thread, they are queued and applied once per frame in Update like the state events.
+	//A zero scale releases the actor's pushed scale
+	static void QueueScaleOverrides(const DCA_API::ScaleUpdate* Updates, size_t Count);
+	static void QueueReleaseAllScaleOverrides();
 	void CharacterControllerStateChanged(RE::bhkCharacterController* Controller, RE::hkpCharacterStateType CurrentState);
-	void CharacterControllerUpdate(RE::bhkCharacterController* Controller);
+	bool CharacterControllerUpdate(ControllerData& Data, const RE::NiPoint3& CameraPosition);
+	bool PrepareControllerShapes(ControllerData& Data);
+	static void ComputeControllerShapes(ControllerData& Data);
+	void CommitPreparedShapes();
 	static bool CheckEnoughSpaceToStand(RE::ActorHandle ActorHandle);
 
 	void DebugDraw();
@@ -66,9 +281,17 @@ class AdjustmentHandler {
 
 	static void AddControllerToMap(RE::bhkCharacterController* Controller, RE::ActorHandle Handle);
 	static void RemoveControllerFromMap(RE::bhkCharacterController* Controller);
-	static void ForEachController(std::function<void(std::shared_ptr<ControllerData>)> Func);
 	static bool CheckSkeletonForCollisionShapes(RE::NiAVObject* Object);
 
+	//Walks the registered controllers in storage order under the controllers read lock, skips the removed ones
+	template <class Func>
+	static void ForEachController(Func&& Fn) {
+		ReadLocker locker(ControllersLock);
+		for (ControllerData& Data : Controllers) {
+			if (Data.CharController) Fn(Data);
+		}
+	}
+
 	private:
 
 	using Lock = std::shared_mutex;
@@ -84,13 +307,76 @@ class AdjustmentHandler {
 
 	AdjustmentHandler& operator=(const AdjustmentHandler&) = delete;
 	AdjustmentHandler& operator=(AdjustmentHandler&&) = delete;
-	static bool GetShapes(RE::bhkCharacterController* CharController, const RE::hkpConvexVerticesShape*& OutConvexShape, std::vector<RE::hkpCapsuleShape*>& OutColisionShape);
+	static void QueueControllerEvent(const ControllerEvent& Event);
+	static void ApplyControllerEvent(ControllerData& Data, const ControllerEvent& Event);
+	static void DrainControllerEvents();
+	static void DrainScaleOverrides();
+	static void PublishColliders();
+	static void RefreshSneakClearance(float BudgetMicroseconds);
+	static void ResolveStandClearance();
+	static bool PrepareClearanceQuery(RE::Actor* ActorPtr, ClearanceService::Query& OutQuery);
+
+	static RE::hkpConvexVerticesShape* BuildConvexShape(const std::vector<RE::hkVector4>& Verts, const ControllerHull::Topology* Layout);
+	static bool BuildHull(const std::vector<RE::hkVector4>& Verts, const ControllerHull::Topology* Layout, ControllerHull::Result& OutHull);
+	static RE::hkpConvexVerticesShape* CreateHullShape(const ControllerHull::Result& Hull);
+	static bool CanRewriteShape(const RE::hkpConvexVerticesShape* Shape);
+	static bool RewriteHullShape(RE::hkpConvexVerticesShape* Shape, const ControllerHull::Result& Hull);
+	static void ReleaseShape(RE::hkpConvexVerticesShape* Shape);
+
+	static bool GetShapes(RE::bhkCharacterController* CharController, const RE::hkpConvexVerticesShape*& OutConvexShape, CapsuleList& OutColisionShape);
 	static bool GetConvexShape(RE::bhkCharacterController* CharController, RE::hkpCharacterProxy*& OutProxy, RE::hkpCharacterRigidBody*& OutRigidBody, RE::hkpListShape*& OutListshape, RE::hkpConvexVerticesShape*& OutConvexShape);
-	static bool GetCapsules(RE::bhkCharacterController* CharController, std::vector<RE::hkpCapsuleShape*>& OutCollisionCapsules);
+	static bool GetCapsules(RE::bhkCharacterController* CharController, CapsuleList& OutCollisionCapsules);
+
+	//Callers must hold ControllersLock for as long as they use the returned pointer
+	static ControllerData* GetControllerData(RE::ActorHandle Handle);
+	static ControllerData* GetControllerData(RE::bhkCharacterController* CharController);
+
+	using ControllerHandle = SlotMap<ControllerData>::Handle;
+
+	static inline SlotMap<ControllerData> Controllers{};
+	static inline std::unordered_map<RE::bhkCharacterController*, ControllerHandle> ControllerHandles{};
+
+	static inline SpillingEventQueue<ControllerEvent, 4096> ControllerEvents{};
+	static inline std::vector<ControllerEvent> PendingEvents{};
+
+	//One lock per pushed batch, a null handle in the queue releases every pushed scale
+	static inline std::mutex ScaleOverrideLock;
+	static inline std::vector<DCA_API::ScaleUpdate> QueuedScaleOverrides{};
+	static inline std::vector<DCA_API::ScaleUpdate> PendingScaleOverrides{};
+	static inline std::unordered_map<RE::ActorHandle, float> ScaleOverrides{};  //Main thread only, outlives the controllers so a reloaded actor keeps its pushed scale
+	static inline SnapshotTable<ColliderEntry, 2048> ColliderSnapshot{};
+
+	//Background stand up clearance of sneaking actors, one batch per frame
+	static inline Scheduler ClearanceScheduler{};
+	static inline std::vector<ClearanceService::Query> ClearanceQueries{};
+	static inline std::vector<ClearanceService::Result> ClearanceResults{};
+	static inline std::vector<uint32_t> ClearanceTargets{};
+	static constexpr size_t MaxClearanceRefreshes = 8;
+
+	//Scaled npc's standing up or growing, checked together once per frame
+	static inline std::vector<ClearanceService::Query> StandQueries{};
+	static inline std::vector<ClearanceService::Result> StandResults{};
+	static inline std::vector<uint32_t> StandTargets{};
+	static inline std::vector<float> StandScales{};  //Scale each query was built for
+	static constexpr float StandRecheckSeconds = 0.5f;  //A held npc that has not moved keeps its blocked answer this long
+	static constexpr float StandGrowthMargin = 0.05f;   //Growth is checked this much bigger, so continuous growth needs a new check only every few percent
+
+	static inline Scheduler AdjustmentScheduler{};
+	static inline std::vector<uint32_t> CommitList{};
+	static inline CapsuleKernel::Batch CapsuleBatch{};  //Every capsule rebuilt this frame
+
+	//First shape out of the generic builder, the specialized builder copies its header (vtable, shape type, convex radius).
+	//Holds a reference that is never released, havok is gone by the time statics get destroyed
+	static inline RE::hkpConvexVerticesShape* TemplateConvexShape = nullptr;
 
-	static std::shared_ptr<ControllerData> GetControllerData(RE::ActorHandle Handle);
-	static std::shared_ptr<ControllerData> GetControllerData(RE::bhkCharacterController* CharController);
+	//Swapped out shapes nobody else referenced anymore, their storage gets rewritten instead of going back to havok's heap
+	static inline std::vector<RE::hkpConvexVerticesShape*> ShapePool{};
+	static constexpr size_t MaxPooledShapes = 64;
+	static inline std::vector<uint32_t> BatchList{};
+	static inline uint32_t WorkerSettingsVersion = UINT32_MAX;
+	static inline uint32_t InternCollectFrame = 0;
 
-	static inline std::unordered_map<RE::bhkCharacterController*, std::shared_ptr<ControllerData>> ControllerMap{};
+	//How often unused interned shapes get dropped
+	static constexpr uint32_t InternCollectInterval = 600;
 	
 };
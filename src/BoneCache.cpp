@@ -0,0 +1,88 @@
+#include "BoneCache.h"
+#include "Stats.h"
+#include "Utils.h"
+
+void BoneCache::Refresh(const RE::Actor* ActorPtr) {
+	if (!ActorPtr || !ActorPtr->Is3DLoaded()) {
+		Clear();
+		return;
+	}
+
+	if (ActorPtr->Get3D(false) == Roots[0].get() && ActorPtr->Get3D(true) == Roots[1].get()) return;
+
+	Resolve(ActorPtr);
+}
+
+void BoneCache::Clear() {
+	for (size_t Person = 0; Person < 2; Person++) {
+		Roots[Person].reset();
+		for (auto& Node : Nodes[Person]) {
+			Node.reset();
+		}
+	}
+}
+
+void BoneCache::Resolve(const RE::Actor* ActorPtr) {
+	Stats::Frame.BoneResolves++;
+
+	//Walked at most once per root, only for bones the game's own lookup can't find
+	static Utils::NiSkeletonIndex Index;
+
+	for (size_t Person = 0; Person < 2; Person++) {
+		RE::NiAVObject* Root = ActorPtr->Get3D(Person == 1);
+		Roots[Person] = RE::NiPointer<RE::NiAVObject>(Root);
+		Index.Clear();
+
+		for (size_t i = 0; i < kBoneCount; i++) {
+			RE::NiAVObject* Node = Root ? Root->GetObjectByName(BoneNames[i]) : nullptr;
+			if (!Node && Root) {
+				if (Index.Empty()) Index.Build(Root);
+				Node = Index.Find(BoneNames[i]);
+			}
+			Nodes[Person][i] = RE::NiPointer<RE::NiAVObject>(Node);
+		}
+	}
+	Index.Clear();
+}
+
+RE::NiAVObject* BoneCache::Get(Bone Index) const {
+	if (RE::NiAVObject* Node = Nodes[0][Index].get()) return Node;
+	return Nodes[1][Index].get();
+}
+
+PoseSnapshot BoneCache::Sample(const RE::Actor* ActorPtr, bool IncludeBones, bool IncludeScale) const {
+	PoseSnapshot Pose{};
+	Pose.WorldScale = *g_worldScale;
+
+	if (IncludeScale) {
+		//Model scale, Scaling done by game
+		if (Roots[0]) {
+			Pose.ModelScale = Roots[0]->local.scale;
+		} else if (Roots[1]) {
+			Pose.ModelScale = Roots[1]->local.scale;
+		}
+
+		//NPC bone, Racemenu uses this. Root is its child, some other mods scale that one instead
+		if (const RE::NiAVObject* Node = Get(kNPC)) Pose.NPCScale = Node->local.scale;
+		if (const RE::NiAVObject* Node = Get(kRoot)) Pose.RootScale = Node->local.scale;
+
+		Pose.Scale = std::clamp(Pose.ModelScale * Pose.NPCScale * Pose.RootScale, 0.15f, 20.f);
+	}
+
+	if (IncludeBones && ActorPtr) {
+		const RE::NiPoint3 Position = ActorPtr->GetPosition();
+
+		if (const RE::NiAVObject* Node = Get(kHead)) {
+			const RE::NiPoint3 Distance = Node->world.translate - Position;
+			Pose.Head = { Distance.x * Pose.WorldScale, Distance.y * Pose.WorldScale, Distance.z * Pose.WorldScale, 0.f };
+		}
+		if (const RE::NiAVObject* Node = Get(kClavicle)) {
+			Pose.ClavicleZ = (Node->world.translate.z - Position.z) * Pose.WorldScale;
+		}
+		if (const RE::NiAVObject* Node = Get(kCalf)) {
+			Pose.CalfZ = (Position.z - Node->world.translate.z) * Pose.WorldScale;
+		}
+	}
+
+	return Pose;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+//Everything the adjust paths read from the actor's skeleton, sampled once per frame
+struct PoseSnapshot {
+	//Relative to the actor, in havok units. Only filled when sampled with bones
+	RE::hkVector4 Head{};
+	float ClavicleZ = 0.f;
+	float CalfZ = 0.f;  //Inverted, below the actor is positive
+
+	float ModelScale = 1.f;
+	float NPCScale = 1.f;
+	float RootScale = 1.f;
+	float WorldScale = 1.f;
+	float Scale = 1.f;  //Product of the three actor scales clamped the same way as Utils::GetScale
+};
+
+//The bones a controller reads every frame, looked up by name once when the actor's 3D shows up instead of on every read.
+//The cache holds references to the 3D roots it resolved against, a root that changed means the 3D was reset or reloaded
+//and everything gets looked up again. Holding them also keeps a freed root's address from being reused for a new one.
+//Main thread only.
+class BoneCache {
+	public:
+
+	enum Bone : uint8_t {
+		kHead,
+		kClavicle,
+		kCalf,
+		kNPC,
+		kRoot,
+
+		kBoneCount
+	};
+
+	//Pointer compares against the current 3D, only searches the skeleton when it changed
+	void Refresh(const RE::Actor* ActorPtr);
+	void Clear();
+
+	[[nodiscard]] bool IsValid() const { return Roots[0] || Roots[1]; }
+
+	//Third person node, first person if the third person skeleton does not have it. Same order Utils::FindBoneNode is used in
+	[[nodiscard]] RE::NiAVObject* Get(Bone Index) const;
+
+	//Reads every cached node once, the head, clavicle and calf only when IncludeBones is set.
+	//Without IncludeScale the scale nodes are left alone and the scales stay at 1, for actors whose scale gets pushed through the api
+	[[nodiscard]] PoseSnapshot Sample(const RE::Actor* ActorPtr, bool IncludeBones, bool IncludeScale = true) const;
+
+	private:
+
+	static constexpr std::array<std::string_view, kBoneCount> BoneNames{
+		"NPC Head [Head]",
+		"NPC R Clavicle [RClv]",
+		"NPC R RearCalf [RrClf]",
+		"NPC",
+		"NPC Root [Root]"
+	};
+
+	void Resolve(const RE::Actor* ActorPtr);
+
+	//[0] Third person, [1] First person
+	std::array<RE::NiPointer<RE::NiAVObject>, 2> Roots{};
+	std::array<std::array<RE::NiPointer<RE::NiAVObject>, kBoneCount>, 2> Nodes{};
+};
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "RingKernel.h"
+
+#include <vector>
+
+//Adjusts the controller capsules of every actor rebuilt this frame in one pass, laid out as structure of arrays.
+//Per capsule, from its original radius R0 and vertices A0/B0 (only y and z change, x and w stay the original's):
+//	Radius = R0 * Scale * 0.8
+//	B.z = B0.z + (Radius - R0)                    Ground offset, the bottom sphere does not sink into the floor
+//	A.z = HeadZ + A0.z * ZScale                   Either towards the head (ZScale -1) or just scaled (HeadZ 0, ZScale Scale)
+//	A.z = B.z + 0.01 if clamped and A.z < B.z     Top vertex never ends up below the bottom one
+//	A.y = A0.y * Scale, B.y = B0.y * Scale        Moved forward with scale
+//The capsules are appended on the main thread, Run does the math and the commit reads the results back by index.
+//Shares RingKernel's instruction set detection. No game or havok types in here.
+namespace CapsuleKernel
+{
+	//The default shape gets stupidly large, so its scale is offset a bit. Arbitrary
+	static constexpr float RadiusFactor = 0.8f;
+	static constexpr float MinimumHeight = 0.01f;
+
+	struct Capsule
+	{
+		float Radius;
+		float AY, AZ;
+		float BY, BZ;
+	};
+
+	struct Params
+	{
+		float Scale = 1.f;
+		float HeadZ = 0.f;
+		float ZScale = 1.f;
+		bool ClampToBottom = false;
+	};
+
+	class Batch
+	{
+	public:
+		//Returns the capsule's index
+		size_t Add(const Capsule& Original, const Params& Adjust)
+		{
+			R0.push_back(Original.Radius);
+			A0Y.push_back(Original.AY);
+			A0Z.push_back(Original.AZ);
+			B0Y.push_back(Original.BY);
+			B0Z.push_back(Original.BZ);
+			Scale.push_back(Adjust.Scale);
+			HeadZ.push_back(Adjust.HeadZ);
+			ZScale.push_back(Adjust.ZScale);
+			Clamp.push_back(Adjust.ClampToBottom ? ~0u : 0u);
+			return R0.size() - 1;
+		}
+
+		//Keeps the storage around for the next frame
+		void Clear()
+		{
+			for (auto* Column : { &R0, &A0Y, &A0Z, &B0Y, &B0Z, &Scale, &HeadZ, &ZScale, &Radius, &AY, &AZ, &BY, &BZ }) {
+				Column->clear();
+			}
+			Clamp.clear();
+		}
+
+		[[nodiscard]] size_t Size() const { return R0.size(); }
+
+		[[nodiscard]] Capsule Get(size_t Index) const { return { Radius[Index], AY[Index], AZ[Index], BY[Index], BZ[Index] }; }
+
+		void Run(RingKernel::Level Path = RingKernel::SupportedLevel());
+
+		void RunScalar(size_t Begin, size_t End);
+		void RunSSE41(size_t Begin, size_t End);
+		void RunAVX2(size_t Begin, size_t End);
+
+	private:
+		//Inputs
+		std::vector<float> R0{}, A0Y{}, A0Z{}, B0Y{}, B0Z{};
+		std::vector<float> Scale{}, HeadZ{}, ZScale{};
+		std::vector<uint32_t> Clamp{};  //All bits set to clamp, loaded as a lane mask
+
+		//Outputs
+		std::vector<float> Radius{}, AY{}, AZ{}, BY{}, BZ{};
+	};
+
+	inline void Batch::RunScalar(size_t Begin, size_t End)
+	{
+		for (size_t i = Begin; i < End; i++) {
+			Radius[i] = R0[i] * Scale[i] * RadiusFactor;
+			BZ[i] = B0Z[i] + (Radius[i] - R0[i]);
+
+			const float Target = HeadZ[i] + A0Z[i] * ZScale[i];
+			AZ[i] = (Clamp[i] && Target < BZ[i]) ? BZ[i] + MinimumHeight : Target;
+
+			AY[i] = A0Y[i] * Scale[i];
+			BY[i] = B0Y[i] * Scale[i];
+		}
+	}
+
+	RING_KERNEL_TARGET("sse4.1")
+	inline void Batch::RunSSE41(size_t Begin, size_t End)
+	{
+		const __m128 Factor = _mm_set1_ps(RadiusFactor);
+		const __m128 Height = _mm_set1_ps(MinimumHeight);
+
+		size_t i = Begin;
+		for (; i + 4 <= End; i += 4) {
+			const __m128 R = _mm_loadu_ps(&R0[i]);
+			const __m128 S = _mm_loadu_ps(&Scale[i]);
+
+			const __m128 NewRadius = _mm_mul_ps(_mm_mul_ps(R, S), Factor);
+			const __m128 NewBZ = _mm_add_ps(_mm_loadu_ps(&B0Z[i]), _mm_sub_ps(NewRadius, R));
+
+			const __m128 Target = _mm_add_ps(_mm_loadu_ps(&HeadZ[i]), _mm_mul_ps(_mm_loadu_ps(&A0Z[i]), _mm_loadu_ps(&ZScale[i])));
+			const __m128 Below = _mm_and_ps(_mm_cmplt_ps(Target, NewBZ), _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&Clamp[i]))));
+
+			_mm_storeu_ps(&Radius[i], NewRadius);
+			_mm_storeu_ps(&BZ[i], NewBZ);
+			_mm_storeu_ps(&AZ[i], _mm_blendv_ps(Target, _mm_add_ps(NewBZ, Height), Below));
+			_mm_storeu_ps(&AY[i], _mm_mul_ps(_mm_loadu_ps(&A0Y[i]), S));
+			_mm_storeu_ps(&BY[i], _mm_mul_ps(_mm_loadu_ps(&B0Y[i]), S));
+		}
+
+		RunScalar(i, End);
+	}
+
+	RING_KERNEL_TARGET("avx2")
+	inline void Batch::RunAVX2(size_t Begin, size_t End)
+	{
+		const __m256 Factor = _mm256_set1_ps(RadiusFactor);
+		const __m256 Height = _mm256_set1_ps(MinimumHeight);
+
+		size_t i = Begin;
+		for (; i + 8 <= End; i += 8) {
+			const __m256 R = _mm256_loadu_ps(&R0[i]);
+			const __m256 S = _mm256_loadu_ps(&Scale[i]);
+
+			const __m256 NewRadius = _mm256_mul_ps(_mm256_mul_ps(R, S), Factor);
+			const __m256 NewBZ = _mm256_add_ps(_mm256_loadu_ps(&B0Z[i]), _mm256_sub_ps(NewRadius, R));
+
+			const __m256 Target = _mm256_add_ps(_mm256_loadu_ps(&HeadZ[i]), _mm256_mul_ps(_mm256_loadu_ps(&A0Z[i]), _mm256_loadu_ps(&ZScale[i])));
+			const __m256 Below = _mm256_and_ps(_mm256_cmp_ps(Target, NewBZ, _CMP_LT_OQ), _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&Clamp[i]))));
+
+			_mm256_storeu_ps(&Radius[i], NewRadius);
+			_mm256_storeu_ps(&BZ[i], NewBZ);
+			_mm256_storeu_ps(&AZ[i], _mm256_blendv_ps(Target, _mm256_add_ps(NewBZ, Height), Below));
+			_mm256_storeu_ps(&AY[i], _mm256_mul_ps(_mm256_loadu_ps(&A0Y[i]), S));
+			_mm256_storeu_ps(&BY[i], _mm256_mul_ps(_mm256_loadu_ps(&B0Y[i]), S));
+		}
+
+		RunSSE41(i, End);
+	}
+
+	inline void Batch::Run(RingKernel::Level Path)
+	{
+		const size_t Count = Size();
+		for (auto* Column : { &Radius, &AY, &AZ, &BY, &BZ }) {
+			Column->resize(Count);
+		}
+
+		switch (Path) {
+			case RingKernel::Level::kAVX2:
+				RunAVX2(0, Count);
+				break;
+			case RingKernel::Level::kSSE41:
+				RunSSE41(0, Count);
+				break;
+			default:
+				RunScalar(0, Count);
+				break;
+		}
+	}
+}
@@ -0,0 +1,121 @@
+#include "ClearanceService.h"
+#include "Settings.h"
+
+#include <algorithm>
+#include <numbers>
+#include <numeric>
+
+bool ClearanceService::FindCached(const Query& Request, uint64_t Frame, float MaxAgeSeconds, Result& OutResult) {
+	std::lock_guard<std::mutex> Guard(Lock);
+	const auto Search = Cache.find(Request.Controller);
+	if (Search == Cache.end()) return false;
+
+	const CacheEntry& Entry = Search->second;
+	if (Entry.Frame != Frame && std::chrono::duration<float>(std::chrono::steady_clock::now() - Entry.Time).count() > MaxAgeSeconds) return false;
+
+	//Checked within the frame too, the stand check and the growth margin check cast different heights for the same controller.
+	//Grown or shrunk since, or moved far enough that the fan would cover different ground
+	const float HeightZ = Request.Height.quad.m128_f32[2];
+	if (std::abs(HeightZ - Entry.Height) > std::abs(HeightZ) * 0.01f) return false;
+
+	const float Tolerance = Request.Radius * MoveToleranceFraction;
+	RE::hkVector4 Origin = Request.Origin;
+	if (Origin.GetDistance3(Entry.Origin) > Tolerance) return false;
+
+	OutResult = Entry.Cached;
+	Pending.CacheHits++;
+	return true;
+}
+
+//Centre ray first, then the fan. Stops at the first hit, one is enough to not stand up
+ClearanceService::Result ClearanceService::CastFan(RE::hkpWorld* World, const Query& Request, uint32_t FanRays, uint32_t& RaysCast) {
+	Result Out{};
+	const float Step = FanRays ? 2.f * std::numbers::pi_v<float> / static_cast<float>(FanRays) : 0.f;
+	const float Offset = Request.Radius * FanRadiusFraction;
+
+	for (uint32_t Ray = 0; Ray <= FanRays; Ray++) {
+		RE::hkVector4 Start = Request.Origin;
+		if (Ray > 0) {
+			const float Angle = static_cast<float>(Ray - 1) * Step;
+			Start.quad.m128_f32[0] += std::cos(Angle) * Offset;
+			Start.quad.m128_f32[1] += std::sin(Angle) * Offset;
+		}
+
+		RE::hkpWorldRayCastInput RaycastInput;
+		RE::hkpWorldRayCastOutput RaycastOutput;
+		RaycastInput.filterInfo = Request.FilterInfo;
+		RaycastInput.from = Start;
+		RaycastInput.to = Start + Request.Height;
+
+		World->CastRay(RaycastInput, RaycastOutput);
+		RaysCast++;
+
+		if (RaycastOutput.HasHit()) {
+			Out.HasSpace = false;
+			Out.BlockedFrom = RaycastInput.from;
+			Out.BlockedTo = RaycastInput.to;
+			break;
+		}
+	}
+
+	return Out;
+}
+
+void ClearanceService::Resolve(std::span<const Query> Queries, uint64_t Frame, std::span<Result> OutResults) {
+	const uint32_t FanRays = std::min(Settings::uStandClearanceRays, MaxFanRays);
+	uint32_t RaysCast = 0;
+
+	//Grouped by world so every world only gets locked once, a batch is nearly always all in the same one
+	std::vector<uint32_t> Order(Queries.size());
+	std::iota(Order.begin(), Order.end(), 0u);
+	std::sort(Order.begin(), Order.end(), [&](uint32_t A, uint32_t B) {
+		return Queries[A].World < Queries[B].World;
+	});
+
+	for (size_t i = 0; i < Order.size();) {
+		RE::bhkWorld* World = Queries[Order[i]].World;
+		size_t End = i;
+		while (End < Order.size() && Queries[Order[End]].World == World) End++;
+
+		if (World) {
+			RE::BSReadLockGuard lock(World->worldLock);
+			RE::hkpWorld* HavokWorld = World->GetWorld1();
+			for (; i < End; i++) {
+				OutResults[Order[i]] = CastFan(HavokWorld, Queries[Order[i]], FanRays, RaysCast);
+			}
+		} else {
+			for (; i < End; i++) {
+				OutResults[Order[i]] = Result{};
+			}
+		}
+	}
+
+	const auto Now = std::chrono::steady_clock::now();
+	std::lock_guard<std::mutex> Guard(Lock);
+	for (size_t i = 0; i < Queries.size(); i++) {
+		if (Queries[i].Controller) {
+			Cache[Queries[i].Controller] = { Frame, Now, Queries[i].Origin, Queries[i].Height.quad.m128_f32[2], OutResults[i] };
+		}
+	}
+	Pending.Queries += static_cast<uint32_t>(Queries.size());
+	Pending.Rays += RaysCast;
+}
+
+void ClearanceService::Forget(const RE::bhkCharacterController* Controller) {
+	std::lock_guard<std::mutex> Guard(Lock);
+	Cache.erase(Controller);
+}
+
+void ClearanceService::Collect(uint64_t MinFrame) {
+	std::lock_guard<std::mutex> Guard(Lock);
+	std::erase_if(Cache, [MinFrame](const auto& Entry) {
+		return Entry.second.Frame < MinFrame;
+	});
+}
+
+ClearanceService::Counters ClearanceService::TakeCounters() {
+	std::lock_guard<std::mutex> Guard(Lock);
+	const Counters Taken = Pending;
+	Pending = {};
+	return Taken;
+}
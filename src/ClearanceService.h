@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <span>
+
+//Stand up clearance checks. A query casts a fan of rays straight up, one from the controller's centre and uStandClearanceRays
+//spread around its hull ring, so overhangs away from the centre line are found too. Queries are grouped by world and every
+//world is read locked once per batch. Results are cached per controller, a check reuses one cast with about the same height
+//from about the same spot, within the frame it was cast on or later as long as it is young enough. Any thread.
+class ClearanceService {
+	public:
+
+	struct Query {
+		RE::bhkWorld* World = nullptr;
+		RE::bhkCharacterController* Controller = nullptr;
+		RE::hkVector4 Origin{};  //Controller position, havok units
+		RE::hkVector4 Height{};  //Standing height, relative to Origin
+		float Radius = 0.f;      //Hull ring radius
+		uint32_t FilterInfo = 0;
+	};
+
+	struct Result {
+		bool HasSpace = true;
+		RE::hkVector4 BlockedFrom{};  //The ray that hit, for the debug draw
+		RE::hkVector4 BlockedTo{};
+	};
+
+	struct Counters {
+		uint32_t Queries = 0;
+		uint32_t CacheHits = 0;
+		uint32_t Rays = 0;
+	};
+
+	static ClearanceService* GetSingleton() {
+		static ClearanceService Singleton;
+		return std::addressof(Singleton);
+	}
+
+	//Fan rays sit this far out on the hull radius, right at the edge they would start inside walls the actor leans against
+	static constexpr float FanRadiusFraction = 0.8f;
+	static constexpr uint32_t MaxFanRays = 16;
+
+	//How far a controller may move, relative to its hull radius, before an older result no longer counts for it
+	static constexpr float MoveToleranceFraction = 0.25f;
+
+	//A result cast from about the same spot with about the same height, on this frame or at most MaxAgeSeconds ago
+	bool FindCached(const Query& Request, uint64_t Frame, float MaxAgeSeconds, Result& OutResult);
+
+	//Casts every query and caches the results for Frame. OutResults has to be as long as Queries
+	void Resolve(std::span<const Query> Queries, uint64_t Frame, std::span<Result> OutResults);
+
+	//Drops a destroyed controller's result, so one the game puts at the same address never gets it
+	void Forget(const RE::bhkCharacterController* Controller);
+
+	//Drops the cache entries of controllers that have not been checked since MinFrame
+	void Collect(uint64_t MinFrame);
+
+	//Counters since the last call, for the stats
+	Counters TakeCounters();
+
+	private:
+
+	struct CacheEntry {
+		uint64_t Frame = 0;
+		std::chrono::steady_clock::time_point Time{};
+		RE::hkVector4 Origin{};
+		float Height = 0.f;
+		Result Cached{};
+	};
+
+	ClearanceService() = default;
+
+	static Result CastFan(RE::hkpWorld* World, const Query& Request, uint32_t FanRays, uint32_t& RaysCast);
+
+	std::mutex Lock;
+	std::unordered_map<const RE::bhkCharacterController*, CacheEntry> Cache{};
+	Counters Pending{};
+};
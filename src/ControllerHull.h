@@ -0,0 +1,309 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+//Hull builder specialized for the character controller's convex shape.
+//The controller hull is two rings of vertices stacked on top of each other, usually closed by an apex above and below.
+//Classify works out which vertex is which once, with the faces known up front the plane equations and havok's
+//transposed vertex blocks can then be written out directly instead of running the general hull builder on every rebuild.
+//No game or havok types in here, vertices are plain xyzw floats.
+namespace ControllerHull
+{
+	static constexpr size_t MaxRingSize = 16;
+	static constexpr int8_t NoApex = -1;
+
+	//Ring indices are in angular order around the up axis, TopRing[i] sits above BottomRing[i]
+	struct Topology
+	{
+		int8_t TopApex;
+		int8_t BottomApex;
+		uint8_t RingSize;
+		uint8_t VertexCount;
+		std::array<uint8_t, MaxRingSize> TopRing;
+		std::array<uint8_t, MaxRingSize> BottomRing;
+	};
+
+	//The layout every humanoid controller uses, same ordering as the debug draw
+	static constexpr Topology Standard18{
+		9,
+		8,
+		8,
+		18,
+		{ 1, 4, 13, 7, 3, 16, 5, 11 },
+		{ 0, 2, 12, 6, 15, 17, 14, 10 }
+	};
+
+	//Very short controllers, no top vert
+	static constexpr Topology Short17{
+		NoApex,
+		8,
+		8,
+		17,
+		{ 1, 4, 12, 7, 3, 15, 5, 10 },
+		{ 0, 2, 11, 6, 14, 16, 13, 9 }
+	};
+
+	static constexpr size_t MaxVertices = MaxRingSize * 2 + 2;
+	static constexpr size_t MaxBlocks = (MaxVertices + 3) / 4;
+	static constexpr size_t MaxPlanes = MaxRingSize * 3;  //Sides plus a triangle fan on each cap
+
+	struct Vector
+	{
+		float X, Y, Z, W;
+	};
+
+	//Same layout as havok's hkFourTransposedPoints, the xyz of four vertices as three lanes of four
+	struct FourVectors
+	{
+		float X[4];
+		float Y[4];
+		float Z[4];
+	};
+
+	struct Result
+	{
+		std::array<FourVectors, MaxBlocks> Blocks;
+		std::array<Vector, MaxPlanes> Planes;  //Outward normal in xyz, w = -dot(normal, point on plane)
+		Vector AabbCenter;
+		Vector AabbHalfExtents;
+		uint32_t BlockCount;
+		uint32_t PlaneCount;
+		uint32_t VertexCount;
+	};
+
+	namespace Detail
+	{
+		inline Vector Sub(const Vector& A, const Vector& B) { return { A.X - B.X, A.Y - B.Y, A.Z - B.Z, 0.f }; }
+		inline float Dot3(const Vector& A, const Vector& B) { return A.X * B.X + A.Y * B.Y + A.Z * B.Z; }
+		inline Vector Cross(const Vector& A, const Vector& B)
+		{
+			return { A.Y * B.Z - A.Z * B.Y, A.Z * B.X - A.X * B.Z, A.X * B.Y - A.Y * B.X, 0.f };
+		}
+
+		//Plane through P with normal N, flipped to face away from Inside. False if N is degenerate
+		inline bool MakePlane(Vector N, const Vector& P, const Vector& Inside, Vector& OutPlane)
+		{
+			const float Length = std::sqrt(Dot3(N, N));
+			if (!(Length > 1e-12f)) return false;
+
+			N = { N.X / Length, N.Y / Length, N.Z / Length, 0.f };
+			if (Dot3(N, Sub(Inside, P)) > 0.f) {
+				N = { -N.X, -N.Y, -N.Z, 0.f };
+			}
+
+			OutPlane = { N.X, N.Y, N.Z, -Dot3(N, P) };
+			return true;
+		}
+
+		//Newell's method, stays stable for rings that are only roughly planar
+		inline Vector RingNormal(const Vector* Verts, const uint8_t* Ring, size_t RingSize)
+		{
+			Vector N{ 0.f, 0.f, 0.f, 0.f };
+			for (size_t i = 0; i < RingSize; i++) {
+				const Vector& A = Verts[Ring[i]];
+				const Vector& B = Verts[Ring[(i + 1) % RingSize]];
+				N.X += (A.Y - B.Y) * (A.Z + B.Z);
+				N.Y += (A.Z - B.Z) * (A.X + B.X);
+				N.Z += (A.X - B.X) * (A.Y + B.Y);
+			}
+			return N;
+		}
+	}
+
+	[[nodiscard]] constexpr bool Matches(const Topology& Layout, size_t VertexCount)
+	{
+		return VertexCount == Layout.VertexCount && VertexCount <= MaxVertices && Layout.RingSize >= 3 && Layout.RingSize <= MaxRingSize;
+	}
+
+	//Groups the vertices into apexes and two rings by height.
+	//An apex is a lone vertex on the up axis below or above everything else, the rest has to split into two equally sized
+	//height levels whose vertices pair up by angle. Returns false for anything else
+	[[nodiscard]] inline bool Classify(const Vector* Verts, size_t VertexCount, Topology& Out)
+	{
+		if (VertexCount < 6 || VertexCount > MaxVertices) return false;
+
+		std::array<uint8_t, MaxVertices> Order{};
+		float MaxRadius = 0.f;
+		for (size_t i = 0; i < VertexCount; i++) {
+			Order[i] = static_cast<uint8_t>(i);
+			MaxRadius = std::fmax(MaxRadius, std::sqrt(Verts[i].X * Verts[i].X + Verts[i].Y * Verts[i].Y));
+		}
+
+		std::sort(Order.begin(), Order.begin() + VertexCount, [Verts](uint8_t A, uint8_t B) { return Verts[A].Z < Verts[B].Z; });
+
+		const float Height = Verts[Order[VertexCount - 1]].Z - Verts[Order[0]].Z;
+		if (!(Height > 0.f) || !(MaxRadius > 0.f)) return false;
+
+		const float LevelTolerance = Height * 0.01f;
+		const float AxisTolerance = MaxRadius * 0.05f;
+		const auto OnAxis = [&](uint8_t Index) {
+			return std::sqrt(Verts[Index].X * Verts[Index].X + Verts[Index].Y * Verts[Index].Y) <= AxisTolerance;
+		};
+
+		size_t First = 0;
+		size_t Last = VertexCount;
+
+		Out.BottomApex = NoApex;
+		if (OnAxis(Order[0]) && Verts[Order[1]].Z - Verts[Order[0]].Z > LevelTolerance) {
+			Out.BottomApex = static_cast<int8_t>(Order[0]);
+			First++;
+		}
+
+		Out.TopApex = NoApex;
+		if (OnAxis(Order[Last - 1]) && Verts[Order[Last - 1]].Z - Verts[Order[Last - 2]].Z > LevelTolerance) {
+			Out.TopApex = static_cast<int8_t>(Order[Last - 1]);
+			Last--;
+		}
+
+		const size_t RingVertices = Last - First;
+		const size_t RingSize = RingVertices / 2;
+		if (RingVertices % 2 != 0 || RingSize < 3 || RingSize > MaxRingSize) return false;
+
+		//The rings have to be two separate levels
+		if (Verts[Order[First + RingSize]].Z - Verts[Order[First + RingSize - 1]].Z <= LevelTolerance) return false;
+
+		const auto Angle = [Verts](uint8_t Index) { return std::atan2(Verts[Index].Y, Verts[Index].X); };
+		const auto ByAngle = [&](uint8_t A, uint8_t B) { return Angle(A) < Angle(B); };
+
+		std::array<uint8_t, MaxRingSize> Bottom{};
+		std::array<uint8_t, MaxRingSize> Top{};
+		for (size_t i = 0; i < RingSize; i++) {
+			if (OnAxis(Order[First + i]) || OnAxis(Order[First + RingSize + i])) return false;
+			Bottom[i] = Order[First + i];
+			Top[i] = Order[First + RingSize + i];
+		}
+
+		std::sort(Bottom.begin(), Bottom.begin() + RingSize, ByAngle);
+		std::sort(Top.begin(), Top.begin() + RingSize, ByAngle);
+
+		//Vertices near +-pi can sort to opposite ends, find the rotation that lines the rings up
+		constexpr float Pi = 3.14159265f;
+		constexpr float AngleTolerance = 0.1f;
+		for (size_t Offset = 0; Offset < RingSize; Offset++) {
+			bool Paired = true;
+			for (size_t i = 0; i < RingSize && Paired; i++) {
+				float Difference = std::fabs(Angle(Top[(i + Offset) % RingSize]) - Angle(Bottom[i]));
+				Difference = std::fmin(Difference, 2.f * Pi - Difference);
+				Paired = Difference <= AngleTolerance;
+			}
+
+			if (!Paired) continue;
+
+			for (size_t i = 0; i < RingSize; i++) {
+				Out.BottomRing[i] = Bottom[i];
+				Out.TopRing[i] = Top[(i + Offset) % RingSize];
+			}
+
+			Out.RingSize = static_cast<uint8_t>(RingSize);
+			Out.VertexCount = static_cast<uint8_t>(VertexCount);
+			return true;
+		}
+
+		return false;
+	}
+
+	//Classify, falling back to the layouts known from the game's own controllers
+	[[nodiscard]] inline bool Resolve(const Vector* Verts, size_t VertexCount, Topology& Out)
+	{
+		if (Classify(Verts, VertexCount, Out)) return true;
+
+		for (const Topology& Known : { Standard18, Short17 }) {
+			if (Known.VertexCount == VertexCount) {
+				Out = Known;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	//Builds the hull of Verts (xyzw, 16 byte stride) for the given layout.
+	//Returns false if the vertices don't actually form a convex hull with that layout, the caller should use the general builder then
+	[[nodiscard]] inline bool Build(const Topology& Layout, const Vector* Verts, size_t VertexCount, Result& Out)
+	{
+		using namespace Detail;
+
+		if (!Matches(Layout, VertexCount)) return false;
+
+		Vector Min = Verts[0];
+		Vector Max = Verts[0];
+		Vector Centroid{ 0.f, 0.f, 0.f, 0.f };
+		for (size_t i = 0; i < VertexCount; i++) {
+			const Vector& V = Verts[i];
+			Min = { std::fmin(Min.X, V.X), std::fmin(Min.Y, V.Y), std::fmin(Min.Z, V.Z), 0.f };
+			Max = { std::fmax(Max.X, V.X), std::fmax(Max.Y, V.Y), std::fmax(Max.Z, V.Z), 0.f };
+			Centroid = { Centroid.X + V.X, Centroid.Y + V.Y, Centroid.Z + V.Z, 0.f };
+		}
+
+		const float InverseCount = 1.f / static_cast<float>(VertexCount);
+		Centroid = { Centroid.X * InverseCount, Centroid.Y * InverseCount, Centroid.Z * InverseCount, 0.f };
+
+		Out.AabbCenter = { (Min.X + Max.X) * 0.5f, (Min.Y + Max.Y) * 0.5f, (Min.Z + Max.Z) * 0.5f, 0.f };
+		Out.AabbHalfExtents = { (Max.X - Min.X) * 0.5f, (Max.Y - Min.Y) * 0.5f, (Max.Z - Min.Z) * 0.5f, 0.f };
+
+		Out.PlaneCount = 0;
+		const auto AddPlane = [&](const Vector& N, const Vector& P) {
+			return MakePlane(N, P, Centroid, Out.Planes[Out.PlaneCount++]);
+		};
+
+		const size_t RingSize = Layout.RingSize;
+		for (size_t i = 0; i < RingSize; i++) {
+			const size_t j = (i + 1) % RingSize;
+			const Vector& TopA = Verts[Layout.TopRing[i]];
+			const Vector& TopB = Verts[Layout.TopRing[j]];
+			const Vector& BottomA = Verts[Layout.BottomRing[i]];
+			const Vector& BottomB = Verts[Layout.BottomRing[j]];
+
+			//Paired ring vertices share their xy, so the side quads are vertical and planar
+			const Vector Along = Sub(TopB, TopA);
+			const Vector Down = Sub(BottomA, TopA).Z != 0.f ? Sub(BottomA, TopA) : Sub(BottomB, TopB);
+			if (!AddPlane(Cross(Along, Down), TopA)) return false;
+		}
+
+		const auto AddCap = [&](int8_t Apex, const std::array<uint8_t, MaxRingSize>& Ring) {
+			if (Apex == NoApex) {
+				return AddPlane(RingNormal(Verts, Ring.data(), RingSize), Verts[Ring[0]]);
+			}
+
+			const Vector& Top = Verts[Apex];
+			for (size_t i = 0; i < RingSize; i++) {
+				const Vector& A = Verts[Ring[i]];
+				const Vector& B = Verts[Ring[(i + 1) % RingSize]];
+				if (!AddPlane(Cross(Sub(A, Top), Sub(B, Top)), Top)) return false;
+			}
+			return true;
+		};
+
+		if (!AddCap(Layout.TopApex, Layout.TopRing)) return false;
+		if (!AddCap(Layout.BottomApex, Layout.BottomRing)) return false;
+
+		//Every vertex has to be on or behind every plane, otherwise the layout assumption broke (ring folded over the apex etc.)
+		const float Extent = std::fmax(Out.AabbHalfExtents.X, std::fmax(Out.AabbHalfExtents.Y, Out.AabbHalfExtents.Z));
+		const float Tolerance = std::fmax(Extent, 1.f) * 1e-4f;
+		for (uint32_t p = 0; p < Out.PlaneCount; p++) {
+			const Vector& Plane = Out.Planes[p];
+			for (size_t i = 0; i < VertexCount; i++) {
+				if (Dot3(Plane, Verts[i]) + Plane.W > Tolerance) return false;
+			}
+		}
+
+		//Pack four vertices per block, the last block is padded with the last vertex like havok does
+		Out.VertexCount = static_cast<uint32_t>(VertexCount);
+		Out.BlockCount = static_cast<uint32_t>((VertexCount + 3) / 4);
+		for (uint32_t b = 0; b < Out.BlockCount; b++) {
+			FourVectors& Block = Out.Blocks[b];
+			for (size_t Lane = 0; Lane < 4; Lane++) {
+				const Vector& V = Verts[std::min(b * 4 + Lane, VertexCount - 1)];
+				Block.X[Lane] = V.X;
+				Block.Y[Lane] = V.Y;
+				Block.Z[Lane] = V.Z;
+			}
+		}
+
+		return true;
+	}
+}
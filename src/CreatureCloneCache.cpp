@@ -0,0 +1,96 @@
+#include "CreatureCloneCache.h"
+#include "Settings.h"
+#include "Stats.h"
+#include "Utils.h"
+
+size_t CreatureCloneCache::KeyHash::operator()(const Key& CloneKey) const {
+	const size_t Hash = std::hash<const RE::bhkShape*>{}(CloneKey.Source);
+	return Hash ^ (static_cast<size_t>(CloneKey.QuantizedScale) * 0x9E3779B97F4A7C15ull);
+}
+
+uint32_t CreatureCloneCache::QuantizeScale(float Scale) {
+	return static_cast<uint32_t>(std::lround(std::max(Scale, 0.f) / ScaleStep));
+}
+
+//Every cloned havok shape comes with its own wrapper, list children included
+uint32_t CreatureCloneCache::EstimateBytes(const RE::hkpShape* Shape, uint32_t Depth) {
+	if (!Shape) return 0;
+
+	uint32_t Bytes = sizeof(RE::bhkShape);
+	switch (Shape->type) {
+		case RE::hkpShapeType::kCapsule:
+			return Bytes + sizeof(RE::hkpCapsuleShape);
+		case RE::hkpShapeType::kConvexVertices: {
+			const RE::hkpConvexVerticesShape* Convex = static_cast<const RE::hkpConvexVerticesShape*>(Shape);
+			return Bytes + sizeof(RE::hkpConvexVerticesShape) + Convex->rotatedVertices.size() * sizeof(RE::hkpConvexVerticesShape::FourVectors) + Convex->planeEquations.size() * sizeof(RE::hkVector4);
+		}
+		case RE::hkpShapeType::kList: {
+			const RE::hkpListShape* ListShape = static_cast<const RE::hkpListShape*>(Shape);
+			Bytes += sizeof(RE::hkpListShape) + ListShape->childInfo.size() * sizeof(RE::hkpListShape::ChildInfo);
+			if (Depth < 8) {
+				for (const RE::hkpListShape::ChildInfo& ChildInfo : ListShape->childInfo) {
+					Bytes += EstimateBytes(ChildInfo.shape, Depth + 1);
+				}
+			}
+			return Bytes;
+		}
+		default:
+			return Bytes + sizeof(RE::hkpShape);
+	}
+}
+
+RE::NiPointer<RE::bhkShape> CreatureCloneCache::Acquire(RE::bhkShape* Source, float Scale) {
+	if (!Source) return nullptr;
+
+	const Key CloneKey{ Source, QuantizeScale(Scale) };
+	if (const auto It = Index.find(CloneKey); It != Index.end()) {
+		Entries.splice(Entries.begin(), Entries, It->second);
+		Stats::Frame.CreatureCloneHits++;
+		return It->second->Clone;
+	}
+
+	//Every creature sharing the clone gets the same scale, whatever it asked for within the step
+	const float CloneScale = static_cast<float>(CloneKey.QuantizedScale) * ScaleStep;
+	RE::NiPointer<RE::bhkShape> Clone(Utils::Clone<RE::bhkShape>(Source, { CloneScale, CloneScale, CloneScale }));
+	if (!Clone) return nullptr;
+
+	Entry& Created = Entries.emplace_front();
+	Created.CloneKey = CloneKey;
+	Created.Source = RE::NiPointer<RE::bhkShape>(Source);
+	Created.Clone = Clone;
+	Created.EstimatedBytes = EstimateBytes(static_cast<const RE::hkpShape*>(Clone->referencedObject.get()));
+
+	Index.emplace(CloneKey, Entries.begin());
+	TotalBytes += Created.EstimatedBytes;
+	Stats::Frame.CreatureClonesCreated++;
+
+	Trim();
+	return Clone;
+}
+
+size_t CreatureCloneCache::Trim() {
+	const uint64_t Budget = static_cast<uint64_t>(Settings::uCreatureCloneBudgetKB) * 1024;
+	if (TotalBytes <= Budget) return 0;
+
+	size_t Dropped = 0;
+	for (auto It = Entries.end(); It != Entries.begin() && TotalBytes > Budget;) {
+		--It;
+
+		//The cache's own reference is the only one left
+		if (It->Clone && It->Clone->GetRefCount() > 1) continue;
+
+		TotalBytes -= It->EstimatedBytes;
+		Index.erase(It->CloneKey);
+		It = Entries.erase(It);
+		Dropped++;
+	}
+
+	Stats::Frame.CreatureCloneEvictions += static_cast<uint32_t>(Dropped);
+	return Dropped;
+}
+
+void CreatureCloneCache::Clear() {
+	Index.clear();
+	Entries.clear();
+	TotalBytes = 0;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <list>
+
+//Scaled clones of creature controller shapes, shared between every creature built on the same shape at the same scale.
+//Creatures of one skeleton share their shape, so a scaled creature needs a clone of its own. The cache keeps one clone per
+//source shape and quantized scale, clones nobody else references anymore get dropped least recently used first once the
+//cache is over uCreatureCloneBudgetKB. Clones still in use are never dropped. Main thread only.
+class CreatureCloneCache {
+	public:
+
+	struct Key {
+		const RE::bhkShape* Source;
+		uint32_t QuantizedScale;
+
+		bool operator==(const Key&) const = default;
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key& CloneKey) const;
+	};
+
+	static CreatureCloneCache* GetSingleton() {
+		static CreatureCloneCache Singleton;
+		return std::addressof(Singleton);
+	}
+
+	//Scales closer together than this share a clone
+	static constexpr float ScaleStep = 0.01f;
+
+	static uint32_t QuantizeScale(float Scale);
+
+	//The clone of Source at Scale, cloned on a miss. nullptr if the source could not be cloned
+	RE::NiPointer<RE::bhkShape> Acquire(RE::bhkShape* Source, float Scale);
+
+	//Drops idle clones until the cache fits its budget, returns how many were dropped
+	size_t Trim();
+	void Clear();
+
+	[[nodiscard]] size_t Size() const { return Entries.size(); }
+	[[nodiscard]] uint64_t Bytes() const { return TotalBytes; }
+
+	private:
+
+	struct Entry {
+		Key CloneKey{};
+		//Keeps the source alive, a freed source's address could come back as a different shape
+		RE::NiPointer<RE::bhkShape> Source = nullptr;
+		RE::NiPointer<RE::bhkShape> Clone = nullptr;
+		uint32_t EstimatedBytes = 0;
+	};
+
+	CreatureCloneCache() = default;
+
+	static uint32_t EstimateBytes(const RE::hkpShape* Shape, uint32_t Depth = 0);
+
+	//Most recently used first
+	std::list<Entry> Entries{};
+	std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> Index{};
+	uint64_t TotalBytes = 0;
+};
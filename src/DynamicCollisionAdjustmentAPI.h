@@ -0,0 +1,133 @@
+#pragma once
+#include <stdint.h>
+
+/*
+* For modders: Copy this file into your own project if you wish to use this API
+*/
+namespace DCA_API
+{
+	constexpr const auto DCAPluginName = "DynamicCollisionAdjustment_GTSMod";
+
+	// Available Dynamic Collision Adjustment interface versions
+	enum class InterfaceVersion : uint8_t
+	{
+		V1,
+		V2
+	};
+
+	// Error types that may be returned by Dynamic Collision Adjustment
+	enum class APIResult : uint8_t
+	{
+		// Your API call was successful
+		OK,
+
+		// The actor handle did not point to a valid actor
+		InvalidActor,
+
+		// The scale was not a finite positive number, nothing was changed for that actor
+		InvalidScale,
+
+		// The actor had no adjusted collider in the last published snapshot (not loaded, or not registered yet)
+		NotRegistered
+	};
+
+	// Result of an actor's stand clearance check
+	enum class Clearance : uint8_t
+	{
+		// Never checked
+		Unknown,
+
+		// There was enough space for the actor to stand up
+		Clear,
+
+		// Something was in the way
+		Blocked
+	};
+
+	// One actor's scale, for batched pushes
+	struct ScaleUpdate
+	{
+		RE::ActorHandle actorHandle;
+		float scale;
+	};
+
+	// An actor's adjusted collider as of the last published snapshot. Positions are relative to the actor, in game units
+	struct ColliderInfo
+	{
+		float scale;            // The scale the collider is adjusted to
+		float height;           // Standing height of the collider
+		float radius;           // Radius of the collider's hull
+		RE::NiPoint3 capsuleA;  // Endpoints and radius of the collider's main capsule
+		RE::NiPoint3 capsuleB;
+		float capsuleRadius;
+		Clearance clearance;    // Result of the actor's last stand clearance check
+		uint32_t clearanceAge;  // Frames between that check and the snapshot
+		uint32_t snapshotFrame; // Frame the snapshot was published on, increases by one every frame the game is not paused
+	};
+
+	// Dynamic Collision Adjustment's modder interface
+	class IVDCA1
+	{
+	public:
+		/// <summary>
+		/// Sets the scale the actor's collision gets adjusted to, replacing the model and NPC node scales that are read otherwise.
+		/// The actor keeps the pushed scale until it is released, so it only has to be pushed again when it changes.
+		/// Scales are clamped to the same 0.15 - 20 range as the polled ones. Safe to call from any thread, applied on the next frame.
+		/// </summary>
+		/// <param name="a_actorHandle">Actor handle</param>
+		/// <param name="a_scale">The actor's total scale, 1 is unscaled</param>
+		/// <returns>OK, InvalidActor or InvalidScale</returns>
+		virtual APIResult PushActorScale(RE::ActorHandle a_actorHandle, float a_scale) noexcept = 0;
+
+		/// <summary>
+		/// Same as PushActorScale for many actors at once, cheaper than pushing them one by one.
+		/// Invalid entries are skipped, the rest still get applied.
+		/// </summary>
+		/// <param name="a_updates">Array of a_count actor handle and scale pairs</param>
+		/// <param name="a_count">Number of entries in a_updates</param>
+		/// <returns>OK, or the error of the last invalid entry</returns>
+		virtual APIResult PushActorScales(const ScaleUpdate* a_updates, uint32_t a_count) noexcept = 0;
+
+		/// <summary>
+		/// Stops using the pushed scale for the given actor, its scale gets read from its nodes again.
+		/// </summary>
+		/// <param name="a_actorHandle">Actor handle</param>
+		virtual void ReleaseActorScale(RE::ActorHandle a_actorHandle) noexcept = 0;
+
+		/// <summary>
+		/// Releases every pushed scale.
+		/// </summary>
+		virtual void ReleaseAllActorScales() noexcept = 0;
+	};
+
+	class IVDCA2 : public IVDCA1
+	{
+	public:
+		/// <summary>
+		/// Reads the actor's adjusted collider from the snapshot published at the end of every frame.
+		/// Lock free and safe to call from any thread, it never waits on the game or the adjustment.
+		/// </summary>
+		/// <param name="a_actorHandle">Actor handle</param>
+		/// <param name="a_outInfo">Filled with the actor's collider when the call succeeds</param>
+		/// <returns>OK, InvalidActor or NotRegistered</returns>
+		virtual APIResult GetColliderInfo(RE::ActorHandle a_actorHandle, ColliderInfo& a_outInfo) const noexcept = 0;
+	};
+
+	typedef void* (*_RequestPluginAPI)(const InterfaceVersion interfaceVersion);
+
+	/// <summary>
+	/// Request the Dynamic Collision Adjustment API interface.
+	/// Recommended: Send your request during or after SKSEMessagingInterface::kMessage_PostLoad to make sure the dll has already been loaded
+	/// </summary>
+	/// <param name="a_interfaceVersion">The interface version to request</param>
+	/// <returns>The pointer to the API singleton, or nullptr if request failed</returns>
+	[[nodiscard]] inline void* RequestPluginAPI(const InterfaceVersion a_interfaceVersion = InterfaceVersion::V2)
+	{
+		auto pluginHandle = GetModuleHandle("DynamicCollisionAdjustment_GTSMod.dll");
+		_RequestPluginAPI requestAPIFunction = (_RequestPluginAPI)GetProcAddress(pluginHandle, "RequestPluginAPI");
+		if (requestAPIFunction) {
+			return requestAPIFunction(a_interfaceVersion);
+		}
+		return nullptr;
+	}
+}
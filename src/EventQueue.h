@@ -0,0 +1,152 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+//Bounded multi producer, single consumer queue (Vyukov's sequenced ring buffer).
+//Push is wait-free for a producer unless it races another producer for the same cell, Pop must only ever be called from one thread.
+//A full queue rejects the push instead of blocking so the caller decides what to do with the overflow.
+template <class T, size_t Capacity>
+class EventQueue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	EventQueue() :
+		Cells(std::make_unique<Cell[]>(Capacity))
+	{
+		for (size_t i = 0; i < Capacity; i++) {
+			Cells[i].Sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	EventQueue(const EventQueue&) = delete;
+	EventQueue& operator=(const EventQueue&) = delete;
+
+	bool Push(const T& Value)
+	{
+		size_t Position = EnqueuePosition.load(std::memory_order_relaxed);
+		Cell* Target;
+
+		for (;;) {
+			Target = &Cells[Position & Mask];
+			const size_t Sequence = Target->Sequence.load(std::memory_order_acquire);
+			const intptr_t Difference = static_cast<intptr_t>(Sequence) - static_cast<intptr_t>(Position);
+
+			if (Difference == 0) {
+				if (EnqueuePosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (Difference < 0) {
+				return false;  //Full, the consumer has not caught up with this lap yet
+			} else {
+				Position = EnqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		Target->Value = Value;
+		Target->Sequence.store(Position + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool Pop(T& OutValue)
+	{
+		Cell& Source = Cells[DequeuePosition & Mask];
+		const size_t Sequence = Source.Sequence.load(std::memory_order_acquire);
+
+		if (static_cast<intptr_t>(Sequence) - static_cast<intptr_t>(DequeuePosition + 1) < 0) {
+			return false;  //Empty, or the producer that claimed this cell has not published it yet
+		}
+
+		OutValue = Source.Value;
+		Source.Sequence.store(DequeuePosition + Capacity, std::memory_order_release);
+		DequeuePosition++;
+		return true;
+	}
+
+	//Consumer side only
+	template <class Func>
+	size_t Drain(Func&& Fn)
+	{
+		size_t Count = 0;
+		T Value;
+		while (Pop(Value)) {
+			Fn(Value);
+			Count++;
+		}
+		return Count;
+	}
+
+	//Consumer side only. False while a producer that already claimed a cell has not published it yet
+	[[nodiscard]] bool Empty() const
+	{
+		return EnqueuePosition.load(std::memory_order_acquire) == DequeuePosition;
+	}
+
+private:
+	static constexpr size_t Mask = Capacity - 1;
+
+	struct Cell
+	{
+		std::atomic<size_t> Sequence;
+		T Value;
+	};
+
+	std::unique_ptr<Cell[]> Cells;
+
+	alignas(64) std::atomic<size_t> EnqueuePosition{ 0 };
+	alignas(64) size_t DequeuePosition = 0;
+};
+
+//EventQueue that never rejects a push. Once the ring is full, pushes spill into a locked vector, and every push after that
+//goes there too until the consumer emptied it, so each producer's events still come out in the order they went in.
+//Only the overflow allocates or locks, the ring keeps the usual case a single atomic push
+template <class T, size_t Capacity>
+class SpillingEventQueue
+{
+public:
+	void Push(const T& Value)
+	{
+		if (!Spilling.load(std::memory_order_acquire) && Ring.Push(Value)) return;
+
+		std::lock_guard<std::mutex> Guard(SpillLock);
+		Spilling.store(true, std::memory_order_release);
+		Spilled.push_back(Value);
+	}
+
+	//Consumer side only
+	template <class Func>
+	size_t Drain(Func&& Fn)
+	{
+		size_t Count = Ring.Drain(Fn);
+
+		//A push into the ring that is still being published came before the spilled ones, they wait for the next drain then
+		if (!Spilling.load(std::memory_order_acquire) || !Ring.Empty()) return Count;
+
+		{
+			std::lock_guard<std::mutex> Guard(SpillLock);
+			std::swap(Spilled, Draining);
+			Spilling.store(false, std::memory_order_release);
+		}
+
+		for (const T& Value : Draining) {
+			Fn(Value);
+		}
+
+		Count += Draining.size();
+		Draining.clear();
+		return Count;
+	}
+
+private:
+	EventQueue<T, Capacity> Ring;
+
+	std::atomic<bool> Spilling{ false };
+	std::mutex SpillLock;
+	std::vector<T> Spilled{};
+	std::vector<T> Draining{};  //Consumer only, swapped with Spilled so the lock is only held for the swap
+};
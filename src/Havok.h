@@ -209,3 +209,16 @@ RE::hkMemoryRouter& hkGetMemoryRouter();
 inline void* hkHeapAlloc(int numBytes) { 
 	return hkGetMemoryRouter().heap->BlockAlloc(numBytes);
 }
+
+// Allocates the way hkArray does so the array can free it, the allocator may round numBytesInOut up
+inline void* hkHeapBufAlloc(int& numBytesInOut) {
+	return hkGetMemoryRouter().heap->BufAlloc(numBytesInOut);
+}
+
+// hkArray keeps its members private, this is its layout
+struct hkRawArray {
+	void* data;
+	int32_t size;
+	int32_t capacityAndFlags;
+};
+static_assert(sizeof(hkRawArray) == sizeof(RE::hkArray<RE::hkVector4>));
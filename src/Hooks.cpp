@@ -27,7 +27,7 @@ namespace Hooks
 
 		auto actor = SKSE::stl::adjust_pointer<RE::Actor>(a_this, ptrOffset);
 		if (actor) {
-			AdjustmentHandler::GetSingleton()->ActorSneakStateChanged(actor->GetHandle(), true);
+			AdjustmentHandler::GetSingleton()->ActorSneakStateChanged(actor, true);
 		}
 		return ret;
 	}
@@ -38,7 +38,7 @@ namespace Hooks
 
 		auto actor = SKSE::stl::adjust_pointer<RE::Actor>(a_this, ptrOffset);
 		if (actor) {
-			AdjustmentHandler::GetSingleton()->ActorSneakStateChanged(actor->GetHandle(), false);
+			AdjustmentHandler::GetSingleton()->ActorSneakStateChanged(actor, false);
 		}
 		return ret;
 	}
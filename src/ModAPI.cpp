@@ -0,0 +1,63 @@
+#include "ModAPI.h"
+#include "AdjustmentHandler.h"
+
+DCA_API::APIResult ModAPI::Validate(RE::ActorHandle ActorHandle, float Scale) {
+	if (!ActorHandle) return DCA_API::APIResult::InvalidActor;
+	if (!std::isfinite(Scale) || Scale <= 0.f) return DCA_API::APIResult::InvalidScale;
+	return DCA_API::APIResult::OK;
+}
+
+DCA_API::APIResult ModAPI::PushActorScale(RE::ActorHandle a_actorHandle, float a_scale) noexcept {
+	const DCA_API::APIResult Result = Validate(a_actorHandle, a_scale);
+	if (Result != DCA_API::APIResult::OK) return Result;
+
+	const DCA_API::ScaleUpdate Update{ a_actorHandle, a_scale };
+	AdjustmentHandler::QueueScaleOverrides(&Update, 1);
+	return Result;
+}
+
+DCA_API::APIResult ModAPI::PushActorScales(const DCA_API::ScaleUpdate* a_updates, uint32_t a_count) noexcept {
+	if (!a_updates || a_count == 0) return DCA_API::APIResult::OK;
+
+	//The queue skips the invalid entries itself, this is only for the result
+	DCA_API::APIResult Result = DCA_API::APIResult::OK;
+	for (uint32_t i = 0; i < a_count; i++) {
+		if (const DCA_API::APIResult EntryResult = Validate(a_updates[i].actorHandle, a_updates[i].scale); EntryResult != DCA_API::APIResult::OK) {
+			Result = EntryResult;
+		}
+	}
+
+	AdjustmentHandler::QueueScaleOverrides(a_updates, a_count);
+	return Result;
+}
+
+void ModAPI::ReleaseActorScale(RE::ActorHandle a_actorHandle) noexcept {
+	if (!a_actorHandle) return;
+
+	//A zero scale releases
+	const DCA_API::ScaleUpdate Update{ a_actorHandle, 0.f };
+	AdjustmentHandler::QueueScaleOverrides(&Update, 1);
+}
+
+void ModAPI::ReleaseAllActorScales() noexcept {
+	AdjustmentHandler::QueueReleaseAllScaleOverrides();
+}
+
+DCA_API::APIResult ModAPI::GetColliderInfo(RE::ActorHandle a_actorHandle, DCA_API::ColliderInfo& a_outInfo) const noexcept {
+	if (!a_actorHandle) return DCA_API::APIResult::InvalidActor;
+
+	AdjustmentHandler::ColliderEntry Entry;
+	uint64_t Frame = 0;
+	if (!AdjustmentHandler::FindCollider(a_actorHandle.native_handle(), Entry, Frame)) return DCA_API::APIResult::NotRegistered;
+
+	a_outInfo.scale = Entry.Scale;
+	a_outInfo.height = Entry.Height;
+	a_outInfo.radius = Entry.Radius;
+	a_outInfo.capsuleA = { Entry.CapsuleA[0], Entry.CapsuleA[1], Entry.CapsuleA[2] };
+	a_outInfo.capsuleB = { Entry.CapsuleB[0], Entry.CapsuleB[1], Entry.CapsuleB[2] };
+	a_outInfo.capsuleRadius = Entry.CapsuleRadius;
+	a_outInfo.clearance = static_cast<DCA_API::Clearance>(Entry.Clearance);
+	a_outInfo.clearanceAge = Entry.Clearance != static_cast<uint8_t>(DCA_API::Clearance::Unknown) ? static_cast<uint32_t>(Frame - Entry.ClearanceFrame) : 0;
+	a_outInfo.snapshotFrame = static_cast<uint32_t>(Frame);
+	return DCA_API::APIResult::OK;
+}
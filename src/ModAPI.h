@@ -0,0 +1,31 @@
+#pragma once
+#include "DynamicCollisionAdjustmentAPI.h"
+
+//What RequestPluginAPI hands out to other plugins. Calls can come from any thread, everything gets queued for the main thread
+class ModAPI : public DCA_API::IVDCA2 {
+	public:
+
+	static ModAPI* GetSingleton() noexcept {
+		static ModAPI Singleton;
+		return std::addressof(Singleton);
+	}
+
+	DCA_API::APIResult PushActorScale(RE::ActorHandle a_actorHandle, float a_scale) noexcept override;
+	DCA_API::APIResult PushActorScales(const DCA_API::ScaleUpdate* a_updates, uint32_t a_count) noexcept override;
+	void ReleaseActorScale(RE::ActorHandle a_actorHandle) noexcept override;
+	void ReleaseAllActorScales() noexcept override;
+
+	DCA_API::APIResult GetColliderInfo(RE::ActorHandle a_actorHandle, DCA_API::ColliderInfo& a_outInfo) const noexcept override;
+
+	private:
+
+	ModAPI() = default;
+	ModAPI(const ModAPI&) = delete;
+	ModAPI(ModAPI&&) = delete;
+	virtual ~ModAPI() = default;
+
+	ModAPI& operator=(const ModAPI&) = delete;
+	ModAPI& operator=(ModAPI&&) = delete;
+
+	static DCA_API::APIResult Validate(RE::ActorHandle ActorHandle, float Scale);
+};
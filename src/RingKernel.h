@@ -0,0 +1,227 @@
+#pragma once
+
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#else
+#	include <cpuid.h>
+#endif
+
+//MSVC lets any intrinsic through, gcc and clang need every function using wider instructions marked
+#if defined(__GNUC__) || defined(__clang__)
+#	define RING_KERNEL_TARGET(Features) __attribute__((target(Features)))
+#else
+#	define RING_KERNEL_TARGET(Features)
+#endif
+
+//Rescales one ring of the controller hull in place, four or eight vertices at a time.
+//Per vertex: z = z * ZScale + ZOffset, optionally pushed up to FloorZ + FloorEpsilon if it ended up at or below the floor,
+//then xy normalized and scaled to Radius (zero length xy stays zero, same as NiPoint3::Unitize). w is cleared.
+//Every path divides by the length and then scales, in that order, like the original loop did, so they all give its bits.
+//Vertices are xyzw floats with a 16 byte stride (hkVector4), picked out by Indices.
+//No game or havok types in here.
+namespace RingKernel
+{
+	struct Params
+	{
+		float ZScale = 1.f;
+		float ZOffset = 0.f;
+		bool ClampToFloor = false;
+		float FloorZ = 0.f;
+		float FloorEpsilon = 0.f;
+		float Radius = 1.f;
+	};
+
+	enum class Level : uint8_t
+	{
+		kScalar,
+		kSSE41,
+		kAVX2
+	};
+
+	//Reference implementation, matches the original per vertex NiPoint3 loop bit for bit
+	inline void ApplyScalar(float (*Verts)[4], const uint8_t* Indices, size_t Count, const Params& Ring)
+	{
+		for (size_t i = 0; i < Count; i++) {
+			float* V = Verts[Indices[i]];
+
+			float Z = V[2] * Ring.ZScale + Ring.ZOffset;
+			if (Ring.ClampToFloor && Z <= Ring.FloorZ) Z = Ring.FloorZ + Ring.FloorEpsilon;
+
+			const float Length = std::sqrt(V[0] * V[0] + V[1] * V[1]);
+			const bool HasLength = Length > FLT_EPSILON;
+
+			V[0] = HasLength ? (V[0] / Length) * Ring.Radius : 0.f;
+			V[1] = HasLength ? (V[1] / Length) * Ring.Radius : 0.f;
+			V[2] = Z;
+			V[3] = 0.f;
+		}
+	}
+
+	namespace Detail
+	{
+		//The four vertices' x, y and z as lanes
+		struct Block
+		{
+			__m128 X, Y, Z;
+		};
+
+		RING_KERNEL_TARGET("sse4.1")
+		inline Block Load4(float (*Verts)[4], const uint8_t* Indices)
+		{
+			__m128 R0 = _mm_loadu_ps(Verts[Indices[0]]);
+			__m128 R1 = _mm_loadu_ps(Verts[Indices[1]]);
+			__m128 R2 = _mm_loadu_ps(Verts[Indices[2]]);
+			__m128 R3 = _mm_loadu_ps(Verts[Indices[3]]);
+			_MM_TRANSPOSE4_PS(R0, R1, R2, R3);
+			return { R0, R1, R2 };
+		}
+
+		RING_KERNEL_TARGET("sse4.1")
+		inline void Store4(float (*Verts)[4], const uint8_t* Indices, const Block& Values)
+		{
+			__m128 R0 = Values.X;
+			__m128 R1 = Values.Y;
+			__m128 R2 = Values.Z;
+			__m128 R3 = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(R0, R1, R2, R3);
+			_mm_storeu_ps(Verts[Indices[0]], R0);
+			_mm_storeu_ps(Verts[Indices[1]], R1);
+			_mm_storeu_ps(Verts[Indices[2]], R2);
+			_mm_storeu_ps(Verts[Indices[3]], R3);
+		}
+
+		RING_KERNEL_TARGET("sse4.1")
+		inline void Rescale4(Block& Values, const Params& Ring)
+		{
+			__m128 Z = _mm_add_ps(_mm_mul_ps(Values.Z, _mm_set1_ps(Ring.ZScale)), _mm_set1_ps(Ring.ZOffset));
+			if (Ring.ClampToFloor) {
+				const __m128 Floor = _mm_set1_ps(Ring.FloorZ);
+				const __m128 BelowFloor = _mm_cmple_ps(Z, Floor);
+				Z = _mm_blendv_ps(Z, _mm_add_ps(Floor, _mm_set1_ps(Ring.FloorEpsilon)), BelowFloor);
+			}
+
+			const __m128 Length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(Values.X, Values.X), _mm_mul_ps(Values.Y, Values.Y)));
+			const __m128 HasLength = _mm_cmpgt_ps(Length, _mm_set1_ps(FLT_EPSILON));
+			const __m128 Radius = _mm_set1_ps(Ring.Radius);
+
+			Values.X = _mm_and_ps(_mm_mul_ps(_mm_div_ps(Values.X, Length), Radius), HasLength);
+			Values.Y = _mm_and_ps(_mm_mul_ps(_mm_div_ps(Values.Y, Length), Radius), HasLength);
+			Values.Z = Z;
+		}
+	}
+
+	//Leftover vertices of rings that are not a multiple of four go through the scalar path
+	RING_KERNEL_TARGET("sse4.1")
+	inline void ApplySSE41(float (*Verts)[4], const uint8_t* Indices, size_t Count, const Params& Ring)
+	{
+		size_t i = 0;
+		for (; i + 4 <= Count; i += 4) {
+			Detail::Block Values = Detail::Load4(Verts, Indices + i);
+			Detail::Rescale4(Values, Ring);
+			Detail::Store4(Verts, Indices + i, Values);
+		}
+		ApplyScalar(Verts, Indices + i, Count - i, Ring);
+	}
+
+	namespace Detail
+	{
+		//Eight vertices in one register, the transposes stay 128 bit since the vertices are scattered
+		RING_KERNEL_TARGET("avx2")
+		inline void Rescale8(float (*Verts)[4], const uint8_t* Indices, const Params& Ring)
+		{
+			const Block Low = Load4(Verts, Indices);
+			const Block High = Load4(Verts, Indices + 4);
+
+			const __m256 X = _mm256_set_m128(High.X, Low.X);
+			const __m256 Y = _mm256_set_m128(High.Y, Low.Y);
+			__m256 Z = _mm256_add_ps(_mm256_mul_ps(_mm256_set_m128(High.Z, Low.Z), _mm256_set1_ps(Ring.ZScale)), _mm256_set1_ps(Ring.ZOffset));
+
+			if (Ring.ClampToFloor) {
+				const __m256 Floor = _mm256_set1_ps(Ring.FloorZ);
+				const __m256 BelowFloor = _mm256_cmp_ps(Z, Floor, _CMP_LE_OQ);
+				Z = _mm256_blendv_ps(Z, _mm256_add_ps(Floor, _mm256_set1_ps(Ring.FloorEpsilon)), BelowFloor);
+			}
+
+			const __m256 Length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(X, X), _mm256_mul_ps(Y, Y)));
+			const __m256 HasLength = _mm256_cmp_ps(Length, _mm256_set1_ps(FLT_EPSILON), _CMP_GT_OQ);
+			const __m256 Radius = _mm256_set1_ps(Ring.Radius);
+
+			const __m256 NewX = _mm256_and_ps(_mm256_mul_ps(_mm256_div_ps(X, Length), Radius), HasLength);
+			const __m256 NewY = _mm256_and_ps(_mm256_mul_ps(_mm256_div_ps(Y, Length), Radius), HasLength);
+
+			Store4(Verts, Indices, { _mm256_castps256_ps128(NewX), _mm256_castps256_ps128(NewY), _mm256_castps256_ps128(Z) });
+			Store4(Verts, Indices + 4, { _mm256_extractf128_ps(NewX, 1), _mm256_extractf128_ps(NewY, 1), _mm256_extractf128_ps(Z, 1) });
+		}
+	}
+
+	RING_KERNEL_TARGET("avx2")
+	inline void ApplyAVX2(float (*Verts)[4], const uint8_t* Indices, size_t Count, const Params& Ring)
+	{
+		size_t i = 0;
+		for (; i + 8 <= Count; i += 8) {
+			Detail::Rescale8(Verts, Indices + i, Ring);
+		}
+		ApplySSE41(Verts, Indices + i, Count - i, Ring);
+	}
+
+	inline Level DetectLevel()
+	{
+		int Info1[4]{};
+		int Info7[4]{};
+#if defined(_MSC_VER)
+		__cpuid(Info1, 1);
+		__cpuidex(Info7, 7, 0);
+#else
+		__cpuid(1, Info1[0], Info1[1], Info1[2], Info1[3]);
+		__cpuid_count(7, 0, Info7[0], Info7[1], Info7[2], Info7[3]);
+#endif
+
+		const bool HasSSE41 = (Info1[2] & (1 << 19)) != 0;
+		const bool HasOSXSave = (Info1[2] & (1 << 27)) != 0;
+		const bool HasAVX = (Info1[2] & (1 << 28)) != 0;
+		const bool HasAVX2 = (Info7[1] & (1 << 5)) != 0;
+
+		//The os also has to save the ymm registers on a context switch
+		bool OSSavesYmm = false;
+		if (HasOSXSave) {
+#if defined(_MSC_VER)
+			OSSavesYmm = (_xgetbv(0) & 0x6) == 0x6;
+#else
+			uint32_t Low, High;
+			__asm__("xgetbv" : "=a"(Low), "=d"(High) : "c"(0));
+			OSSavesYmm = (Low & 0x6) == 0x6;
+#endif
+		}
+
+		if (HasAVX && HasAVX2 && OSSavesYmm) return Level::kAVX2;
+		if (HasSSE41) return Level::kSSE41;
+		return Level::kScalar;
+	}
+
+	[[nodiscard]] inline Level SupportedLevel()
+	{
+		static const Level Detected = DetectLevel();
+		return Detected;
+	}
+
+	inline void Apply(float (*Verts)[4], const uint8_t* Indices, size_t Count, const Params& Ring, Level Path = SupportedLevel())
+	{
+		switch (Path) {
+			case Level::kAVX2:
+				ApplyAVX2(Verts, Indices, Count, Ring);
+				break;
+			case Level::kSSE41:
+				ApplySSE41(Verts, Indices, Count, Ring);
+				break;
+			default:
+				ApplyScalar(Verts, Indices, Count, Ring);
+				break;
+		}
+	}
+}
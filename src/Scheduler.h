@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+//Orders the pending adjustment work of a frame and hands it out until the frame budget is spent.
+//Jobs that don't fit are left to the caller, which is expected to push them again next frame with a higher age.
+template <class Key>
+class FrameScheduler
+{
+public:
+	enum class Tier : uint8_t
+	{
+		kPlayer,    //Always processed, regardless of the budget
+		kFollower,
+		kNPC
+	};
+
+	struct Job
+	{
+		Key Id;
+		Tier JobTier;
+		float Distance;
+		uint32_t Age;
+		float Score;
+	};
+
+	//Every tier step weighs as much as this distance, every frame of waiting makes up for AgingDistance.
+	//An old enough npc job eventually outranks a fresh follower job so nothing starves.
+	static constexpr float TierDistance = 4096.f;
+	static constexpr float AgingDistance = 512.f;
+
+	void Clear()
+	{
+		Jobs.clear();
+		Processed = 0;
+	}
+
+	void Push(Key Id, Tier JobTier, float Distance, uint32_t Age)
+	{
+		const float Score = static_cast<float>(JobTier) * TierDistance + Distance - static_cast<float>(Age) * AgingDistance;
+		Jobs.push_back({ Id, JobTier, Distance, Age, Score });
+	}
+
+	//Hands the jobs out in priority order, BatchSize at a time and at most MaxJobs of them, and stops once BudgetMicroseconds are used up.
+	//Fn receives a pointer to the first job of a batch and the batch's size so the batch can be processed in parallel.
+	//Returns the number of jobs that ran, the rest can be read back through ForEachDeferred().
+	template <class Func>
+	size_t Run(float BudgetMicroseconds, size_t MaxJobs, size_t BatchSize, Func&& Fn)
+	{
+		const auto ByScore = [](const Job& A, const Job& B) {
+			if (A.JobTier == Tier::kPlayer || B.JobTier == Tier::kPlayer) {
+				return A.JobTier < B.JobTier;
+			}
+			return A.Score < B.Score;
+		};
+
+		const size_t Considered = std::min(Jobs.size(), std::max<size_t>(MaxJobs, 1));
+		std::partial_sort(Jobs.begin(), Jobs.begin() + Considered, Jobs.end(), ByScore);
+
+		const auto Start = std::chrono::steady_clock::now();
+		const auto Budget = std::chrono::duration<float, std::micro>(BudgetMicroseconds);
+		BatchSize = std::max<size_t>(BatchSize, 1);
+
+		Processed = 0;
+		while (Processed < Considered) {
+			//Always let the first batch through so a tiny budget can't stall everything, the player is always in it
+			if (Processed > 0 && std::chrono::steady_clock::now() - Start >= Budget) {
+				break;
+			}
+
+			const size_t Count = std::min(BatchSize, Considered - Processed);
+			Fn(Jobs.data() + Processed, Count);
+			Processed += Count;
+		}
+
+		return Processed;
+	}
+
+	[[nodiscard]] size_t Size() const { return Jobs.size(); }
+
+	//Jobs that were pushed but did not run in the last Run
+	template <class Func>
+	void ForEachDeferred(Func&& Fn) const
+	{
+		for (size_t i = Processed; i < Jobs.size(); i++) {
+			Fn(Jobs[i]);
+		}
+	}
+
+private:
+	std::vector<Job> Jobs{};
+	size_t Processed = 0;
+};
@@ -26,14 +26,30 @@ void Settings::ReadSettings() {
 	// General
 	ReadBoolSetting(mcm, "General", "bEnableActorScaleFix", bEnableActorScaleFix);
 	ReadBoolSetting(mcm, "General", "bEnableStateAdjustments", bEnableStateAdjustments);
+	ReadBoolSetting(mcm, "General", "bEnableCreatureScaling", bEnableCreatureScaling);
+	ReadUInt32Setting(mcm, "General", "uStandClearanceRays", uStandClearanceRays);
+	ReadBoolSetting(mcm, "General", "bNPCStandClearance", bNPCStandClearance);
 	
 	ReadFloatSetting(mcm, "General", "fSneakControllerCapsuleHeightMultiplier", fSneakControllerShapeHeightMultiplier);
 	ReadFloatSetting(mcm, "General", "fSwimmingControllerShapeHeightMultiplier", fSwimmingControllerShapeHeightMultiplier);
 	ReadFloatSetting(mcm, "General", "fSwimmingControllerShapeRadiusMultiplier", fSwimmingControllerShapeRadiusMultiplier);
 
+	// Performance
+	ReadFloatSetting(mcm, "Performance", "fFrameBudgetMicroseconds", fFrameBudgetMicroseconds);
+	ReadUInt32Setting(mcm, "Performance", "uMaxBacklog", uMaxBacklog);
+	ReadUInt32Setting(mcm, "Performance", "uCreatureCloneBudgetKB", uCreatureCloneBudgetKB);
+	ReadFloatSetting(mcm, "Performance", "fSneakClearanceHz", fSneakClearanceHz);
+	ReadUInt32Setting(mcm, "Performance", "uWorkerThreads", uWorkerThreads);
+	ReadFloatSetting(mcm, "Performance", "fLODNearDistance", fLODNearDistance);
+	ReadFloatSetting(mcm, "Performance", "fLODFarDistance", fLODFarDistance);
+	ReadFloatSetting(mcm, "Performance", "fLODHysteresis", fLODHysteresis);
+
 	// Debug
 	ReadUInt32Setting(mcm, "Debug", "uDisplayDebugShapes", (uint32_t&)uDisplayDebugShapes);
 	ReadBoolSetting(mcm, "Debug", "bDisplayCharacterBumper", bDisplayCharacterBumper);
+	ReadBoolSetting(mcm, "Debug", "bLogStatistics", bLogStatistics);
+
+	uSettingsVersion++;
 
 	logger::info("...success");
 }
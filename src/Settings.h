@@ -22,17 +22,36 @@ struct Settings {
 	// General
 	static inline bool bEnableActorScaleFix = true;
 	static inline bool bEnableStateAdjustments = true;
+	static inline bool bEnableCreatureScaling = false;  // swaps scaled creatures onto a shared scaled clone of their shape
+	static inline uint32_t uStandClearanceRays = 4;     // rays spread around the hull for the stand up check, besides the one from the centre
+	static inline bool bNPCStandClearance = true;       // scaled npc's keep their sneaking or smaller shape until there is room to stand up or grow
 
 	static inline float fSneakControllerShapeHeightMultiplier = 0.75f;
 	static inline float fSwimmingControllerShapeHeightMultiplier = 0.75f;
 	static inline float fSwimmingControllerShapeRadiusMultiplier = 2.f;
 
+	// Performance
+	static inline float fFrameBudgetMicroseconds = 1000.f;  // <= 0 disables the budget
+	static inline uint32_t uMaxBacklog = 128;
+	static inline uint32_t uCreatureCloneBudgetKB = 256;  // unused creature shape clones past this get dropped, least recently used first
+	static inline float fSneakClearanceHz = 5.f;  // how often sneaking actors get their stand up clearance checked in the background, 0 only checks on the sneak button
+	static inline uint32_t uWorkerThreads = 0;  // threads for the shape math besides the main thread, 0 picks a quarter of the cores (1 to 4)
+
+	// Level Of Detail, distances are in game units from the camera. The player and followers always use the near tier
+	static inline float fLODNearDistance = 0.f;     // npc's closer than this get bone tracked shapes, 0 leaves that to the player and followers
+	static inline float fLODFarDistance = 6144.f;   // npc's further away than this keep their last shape until they come closer
+	static inline float fLODHysteresis = 256.f;     // how far past a tier boundary an actor has to move before its tier changes
+
 	// Debug
 	static inline DebugDrawMode uDisplayDebugShapes = DebugDrawMode::kNone;
 	static inline bool bDisplayCharacterBumper = false;
+	static inline bool bLogStatistics = false;
 
 	// Non-MCM
 	static inline TRUEHUD_API::IVTrueHUD4* g_trueHUD = nullptr;
 	static inline RE::TESGlobal* glob_trueHUD = nullptr;
 	static inline RE::BGSKeyword* kywd_NPC = nullptr;
+
+	//Bumped on every ReadSettings so controllers know their shapes were built with stale values
+	static inline uint32_t uSettingsVersion = 0;
 };
@@ -0,0 +1,102 @@
+#include "ShapeIntern.h"
+
+namespace {
+	//FNV-1a
+	constexpr uint64_t HashOffset = 0xcbf29ce484222325ull;
+	constexpr uint64_t HashPrime = 0x100000001b3ull;
+
+	inline uint64_t HashBytes(uint64_t Hash, const void* Data, size_t Size) {
+		const uint8_t* Bytes = static_cast<const uint8_t*>(Data);
+		for (size_t i = 0; i < Size; i++) {
+			Hash ^= Bytes[i];
+			Hash *= HashPrime;
+		}
+		return Hash;
+	}
+}
+
+size_t ShapeInternTable::KeyHash::operator()(const Key& InternKey) const {
+	uint64_t Hash = InternKey.VertsHash;
+	Hash = HashBytes(Hash, &InternKey.QuantizedScale, sizeof(InternKey.QuantizedScale));
+	Hash = HashBytes(Hash, &InternKey.State, sizeof(InternKey.State));
+	Hash = HashBytes(Hash, &InternKey.SneakHeightMult, sizeof(InternKey.SneakHeightMult));
+	Hash = HashBytes(Hash, &InternKey.SwimHeightMult, sizeof(InternKey.SwimHeightMult));
+	Hash = HashBytes(Hash, &InternKey.SwimRadiusMult, sizeof(InternKey.SwimRadiusMult));
+	return static_cast<size_t>(Hash);
+}
+
+uint64_t ShapeInternTable::HashVertices(const std::vector<RE::hkVector4>& Verts, float Radius) {
+	uint64_t Hash = HashOffset;
+	for (const RE::hkVector4& Vert : Verts) {
+		Hash = HashBytes(Hash, Vert.quad.m128_f32, sizeof(float) * 3);
+	}
+	return HashBytes(Hash, &Radius, sizeof(Radius));
+}
+
+RE::hkpConvexVerticesShape* ShapeInternTable::Find(const Key& InternKey) const {
+	const auto It = Entries.find(InternKey);
+	return It != Entries.end() ? It->second.Shape.get() : nullptr;
+}
+
+void ShapeInternTable::Insert(const Key& InternKey, RE::hkpConvexVerticesShape* Shape, RE::bhkShape* OwnerWrapper, size_t VertexCount) {
+	if (!Shape) return;
+
+	//The hull keeps its vertices transposed in blocks of four plus roughly a plane per vertex
+	const size_t VertexBlocks = (VertexCount + 3) / 4;
+	const uint32_t Bytes = static_cast<uint32_t>(sizeof(RE::hkpConvexVerticesShape) + VertexBlocks * 3 * sizeof(RE::hkVector4) + VertexCount * sizeof(RE::hkVector4));
+
+	Entry& Target = Entries[InternKey];
+	if (Target.Shape) {
+		EntryBytes.erase(Target.Shape.get());
+	}
+
+	Target.Shape = RE::hkRefPtr<RE::hkpConvexVerticesShape>(Shape);
+	Target.OwnerWrapper = RE::NiPointer<RE::bhkShape>(OwnerWrapper);
+	Target.EstimatedBytes = Bytes;
+	EntryBytes[Shape] = Bytes;
+}
+
+size_t ShapeInternTable::Collect() {
+	size_t Dropped = 0;
+	for (auto It = Entries.begin(); It != Entries.end();) {
+		RE::hkpConvexVerticesShape* Shape = It->second.Shape.get();
+		//The table's own reference, plus the owner wrapper's as long as it still points at the shape.
+		//Once the builder unloads the table holds the only reference to that wrapper
+		const RE::bhkShape* Owner = It->second.OwnerWrapper.get();
+		int32_t OwnReferences = 1;
+		if (Owner && Owner->referencedObject.get() == Shape) OwnReferences++;
+
+		if (!Shape || Shape->GetReferenceCount() <= OwnReferences) {
+			EntryBytes.erase(Shape);
+			It = Entries.erase(It);
+			Dropped++;
+		} else {
+			++It;
+		}
+	}
+	return Dropped;
+}
+
+void ShapeInternTable::Clear() {
+	Entries.clear();
+	EntryBytes.clear();
+}
+
+ShapeInternTable::SharingReport ShapeInternTable::BuildReport(const std::vector<const RE::hkpConvexVerticesShape*>& ShapesInUse) const {
+	SharingReport Report{};
+	std::unordered_map<const RE::hkpConvexVerticesShape*, uint32_t> UsersPerShape{};
+
+	for (const RE::hkpConvexVerticesShape* Shape : ShapesInUse) {
+		if (EntryBytes.contains(Shape)) {
+			UsersPerShape[Shape]++;
+		}
+	}
+
+	for (const auto& [Shape, Users] : UsersPerShape) {
+		Report.Shapes++;
+		Report.Users += Users;
+		Report.BytesSaved += static_cast<uint64_t>(Users - 1) * EntryBytes.at(Shape);
+	}
+
+	return Report;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+//Global table of the scale only convex shapes, shared between every controller built from the same parameters.
+//A city full of npc's of the same race ends up with one hull per distinct scale/state instead of one per actor.
+//Interned shapes are never modified after they are built. Main thread only.
+class ShapeInternTable {
+	public:
+
+	struct Key {
+		uint64_t VertsHash;        //Original vertices and radius of the controller's shape
+		uint32_t QuantizedScale;
+		uint32_t State;            //0 Standing, 1 Sneaking, 2 Swimming
+		uint32_t SneakHeightMult;  //Bit patterns of the multipliers the shape was built with
+		uint32_t SwimHeightMult;
+		uint32_t SwimRadiusMult;
+
+		bool operator==(const Key&) const = default;
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key& InternKey) const;
+	};
+
+	struct SharingReport {
+		uint32_t Shapes = 0;      //Distinct interned shapes currently in use
+		uint32_t Users = 0;       //Controllers using one of them
+		uint64_t BytesSaved = 0;  //Estimated, what the shared copies would have cost
+	};
+
+	static ShapeInternTable* GetSingleton() {
+		static ShapeInternTable Singleton;
+		return std::addressof(Singleton);
+	}
+
+	static uint64_t HashVertices(const std::vector<RE::hkVector4>& Verts, float Radius);
+
+	//Does not add a reference, the caller takes its own
+	RE::hkpConvexVerticesShape* Find(const Key& InternKey) const;
+	void Insert(const Key& InternKey, RE::hkpConvexVerticesShape* Shape, RE::bhkShape* OwnerWrapper, size_t VertexCount);
+
+	//Drops every shape nobody but the table holds anymore, returns how many were dropped
+	size_t Collect();
+	void Clear();
+
+	[[nodiscard]] size_t Size() const { return Entries.size(); }
+
+	SharingReport BuildReport(const std::vector<const RE::hkpConvexVerticesShape*>& ShapesInUse) const;
+
+	private:
+
+	struct Entry {
+		RE::hkRefPtr<RE::hkpConvexVerticesShape> Shape{};
+		//The shape's userData may point at the wrapper of the controller that built it, so that wrapper has to outlive the shape
+		RE::NiPointer<RE::bhkShape> OwnerWrapper = nullptr;
+		uint32_t EstimatedBytes = 0;
+	};
+
+	ShapeInternTable() = default;
+
+	std::unordered_map<Key, Entry, KeyHash> Entries{};
+	std::unordered_map<const RE::hkpConvexVerticesShape*, uint32_t> EntryBytes{};
+};
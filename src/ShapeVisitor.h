@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+//One shape tree walk for every lookup, the shape types to collect are picked at compile time so the walk only carries the
+//code for what was asked for. Results go into fixed size inline buffers, a walk never allocates.
+//No game types in here, Traits tells it how to read the tree:
+//	using Shape, Capsule, Convex, ChildBuffer;
+//	static Kind TypeOf(const Shape*);
+//	static Capsule* AsCapsule(const Shape*);
+//	static Convex* AsConvex(const Shape*);
+//	template <class Fn> static void ForEachListChild(const Shape*, Fn&&);                  //Fn(const Shape* Child)
+//	template <class Fn> static void ForEachContainerChild(const Shape*, ChildBuffer&, Fn&&);  //Same, for trees whose children are built into a buffer
+namespace ShapeVisitor
+{
+	enum class Kind : uint8_t
+	{
+		kOther,
+		kCapsule,
+		kConvex,
+		kList,
+		kContainer
+	};
+
+	enum Collect : uint8_t
+	{
+		kCapsules = 1 << 0,
+		kConvexShape = 1 << 1
+	};
+
+	//Pointers past Capacity are dropped and counted, a fixed vector without the heap
+	template <class T, size_t Capacity>
+	class InlineBuffer
+	{
+	public:
+		bool push_back(T Value)
+		{
+			if (Count == Capacity) {
+				Dropped++;
+				return false;
+			}
+			Items[Count++] = Value;
+			return true;
+		}
+
+		void clear()
+		{
+			Count = 0;
+			Dropped = 0;
+		}
+
+		[[nodiscard]] size_t size() const { return Count; }
+		[[nodiscard]] bool empty() const { return Count == 0; }
+		[[nodiscard]] size_t dropped() const { return Dropped; }
+
+		[[nodiscard]] T& operator[](size_t Index) { return Items[Index]; }
+		[[nodiscard]] const T& operator[](size_t Index) const { return Items[Index]; }
+
+		[[nodiscard]] T* begin() { return Items.data(); }
+		[[nodiscard]] T* end() { return Items.data() + Count; }
+		[[nodiscard]] const T* begin() const { return Items.data(); }
+		[[nodiscard]] const T* end() const { return Items.data() + Count; }
+
+	private:
+		std::array<T, Capacity> Items{};
+		size_t Count = 0;
+		size_t Dropped = 0;
+	};
+
+	template <class Traits, uint8_t What, size_t MaxCapsules = 16>
+	struct Result
+	{
+		InlineBuffer<typename Traits::Capsule*, MaxCapsules> Capsules{};
+		typename Traits::Convex* ConvexShape = nullptr;  //The first one found
+
+		void clear()
+		{
+			Capsules.clear();
+			ConvexShape = nullptr;
+		}
+	};
+
+	//Container children may live in the buffer they were built into, so every level of the walk gets its own, reused
+	//for all children on that level. Deeper trees than MaxDepth are not walked
+	template <class Traits, size_t MaxDepth = 8>
+	class Walker
+	{
+	public:
+		template <uint8_t What, size_t MaxCapsules>
+		void Visit(const typename Traits::Shape* Root, Result<Traits, What, MaxCapsules>& Out)
+		{
+			VisitShape<What>(Root, Out, 0);
+		}
+
+	private:
+		template <uint8_t What, size_t MaxCapsules>
+		void VisitShape(const typename Traits::Shape* Shape, Result<Traits, What, MaxCapsules>& Out, size_t Depth)
+		{
+			if (!Shape || Depth >= MaxDepth) return;
+
+			const auto VisitChild = [&](const typename Traits::Shape* Child) {
+				VisitShape<What>(Child, Out, Depth + 1);
+			};
+
+			switch (Traits::TypeOf(Shape)) {
+				case Kind::kCapsule:
+					if constexpr ((What & kCapsules) != 0) {
+						if (auto* Capsule = Traits::AsCapsule(Shape)) Out.Capsules.push_back(Capsule);
+					}
+					break;
+
+				case Kind::kConvex:
+					if constexpr ((What & kConvexShape) != 0) {
+						if (!Out.ConvexShape) Out.ConvexShape = Traits::AsConvex(Shape);
+					}
+					break;
+
+				case Kind::kList:
+					Traits::ForEachListChild(Shape, VisitChild);
+					break;
+
+				case Kind::kContainer:
+					Traits::ForEachContainerChild(Shape, Buffers[Depth], VisitChild);
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		std::array<typename Traits::ChildBuffer, MaxDepth> Buffers{};
+	};
+}
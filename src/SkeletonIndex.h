@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+//Flat pre-order index of a node tree with a table of name hashes, built in one walk and searched by binary search.
+//Search walks the tree for a single name without building anything, for one off lookups that is cheaper.
+//Every buffer is kept between calls, once warmed up on a skeleton of the same size nothing allocates.
+//No game types in here, Traits tells it how to walk the tree:
+//	static const char* Name(NodeT* Node);
+//	template <class Fn> static void ForEachChild(NodeT* Node, Fn&& Callback);  //Callback(NodeT* Child), children in order
+template <class NodeT, class Traits>
+class SkeletonIndex {
+	public:
+
+	static constexpr int32_t NoParent = -1;
+
+	struct Entry {
+		NodeT* Node;
+		int32_t Parent;    //Index into Entries(), NoParent for the root
+		const char* Name;  //Interned by the game, only valid as long as the node is
+	};
+
+	//MaxNodes guards against broken trees with cycles, the walk stops there and the index keeps what it found
+	void Build(NodeT* Root, size_t MaxNodes = 4096) {
+		Clear();
+
+		Walk(Root, MaxNodes, [this](NodeT* Node, int32_t Parent, const char* Name) {
+			ByName.push_back({ Hash(Name), static_cast<uint32_t>(Nodes.size()) });
+			Nodes.push_back({ Node, Parent, Name });
+			return false;
+		});
+
+		//Ties keep their pre-order, a duplicate name resolves to the first one
+		std::sort(ByName.begin(), ByName.end());
+	}
+
+	//Pre-order walk that stops at the first match, same result as building and calling Find
+	[[nodiscard]] NodeT* Search(NodeT* Root, std::string_view Name, size_t MaxNodes = 4096) {
+		NodeT* Found = nullptr;
+		Walk(Root, MaxNodes, [&Found, Name](NodeT* Node, int32_t, const char* NodeName) {
+			if (std::string_view(NodeName) != Name) return false;
+			Found = Node;
+			return true;
+		});
+		return Found;
+	}
+
+	void Clear() {
+		Nodes.clear();
+		ByName.clear();
+		Stack.clear();
+	}
+
+	[[nodiscard]] NodeT* Find(std::string_view Name) const {
+		const uint64_t NameHash = Hash(Name);
+		for (auto It = std::lower_bound(ByName.begin(), ByName.end(), NameKey{ NameHash, 0 }); It != ByName.end() && It->Hash == NameHash; ++It) {
+			if (std::string_view(Nodes[It->Index].Name) == Name) return Nodes[It->Index].Node;
+		}
+		return nullptr;
+	}
+
+	[[nodiscard]] const std::vector<Entry>& Entries() const { return Nodes; }
+	[[nodiscard]] bool Empty() const { return Nodes.empty(); }
+
+	private:
+
+	struct Pending {
+		NodeT* Node;
+		int32_t Parent;
+	};
+
+	struct NameKey {
+		uint64_t Hash;
+		uint32_t Index;
+
+		bool operator<(const NameKey& Other) const { return Hash != Other.Hash ? Hash < Other.Hash : Index < Other.Index; }
+	};
+
+	//FNV-1a
+	static uint64_t Hash(std::string_view Name) {
+		uint64_t Value = 0xcbf29ce484222325ull;
+		for (const char Character : Name) {
+			Value ^= static_cast<uint8_t>(Character);
+			Value *= 0x100000001b3ull;
+		}
+		return Value;
+	}
+
+	//Visit(Node, Parent, Name) returns true to stop. Parent is the index the node would get in a full walk.
+	//MaxNodes guards against broken trees with cycles
+	template <class Fn>
+	void Walk(NodeT* Root, size_t MaxNodes, Fn&& Visit) {
+		Stack.clear();
+		if (Root) Stack.push_back({ Root, NoParent });
+
+		for (int32_t Visited = 0; !Stack.empty() && static_cast<size_t>(Visited) < MaxNodes; Visited++) {
+			const Pending Current = Stack.back();
+			Stack.pop_back();
+
+			const char* Name = Traits::Name(Current.Node);
+			if (Visit(Current.Node, Current.Parent, Name ? Name : "")) break;
+
+			//Pushed in reverse so the first child is popped first and the order stays pre-order
+			const size_t First = Stack.size();
+			Traits::ForEachChild(Current.Node, [this, Visited](NodeT* Child) {
+				if (Child) Stack.push_back({ Child, Visited });
+			});
+			std::reverse(Stack.begin() + First, Stack.end());
+		}
+
+		Stack.clear();
+	}
+
+	std::vector<Entry> Nodes{};
+	std::vector<NameKey> ByName{};
+	std::vector<Pending> Stack{};  //Scratch for the walk
+};
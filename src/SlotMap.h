@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+//Dense, generation checked storage.
+//Values live contiguously so iterating is a linear walk, erasing swaps the last value into the hole.
+//Handles survive other inserts/erases and go stale (instead of dangling) once their slot gets reused.
+template <class T>
+class SlotMap
+{
+public:
+	struct Handle
+	{
+		uint32_t Index = UINT32_MAX;
+		uint32_t Generation = 0;
+
+		[[nodiscard]] bool IsValid() const { return Index != UINT32_MAX; }
+		bool operator==(const Handle&) const = default;
+	};
+
+	template <class... Args>
+	Handle Emplace(Args&&... Arguments)
+	{
+		uint32_t SlotIndex;
+		if (FreeHead != UINT32_MAX) {
+			SlotIndex = FreeHead;
+			FreeHead = Slots[SlotIndex].DenseIndex;
+		} else {
+			SlotIndex = static_cast<uint32_t>(Slots.size());
+			Slots.push_back({});
+		}
+
+		Values.emplace_back(std::forward<Args>(Arguments)...);
+		DenseToSlot.push_back(SlotIndex);
+		Slots[SlotIndex].DenseIndex = static_cast<uint32_t>(Values.size() - 1);
+
+		return { SlotIndex, Slots[SlotIndex].Generation };
+	}
+
+	bool Erase(Handle SlotHandle)
+	{
+		if (!Contains(SlotHandle)) return false;
+
+		const uint32_t DenseIndex = Slots[SlotHandle.Index].DenseIndex;
+		const uint32_t LastIndex = static_cast<uint32_t>(Values.size() - 1);
+
+		if (DenseIndex != LastIndex) {
+			Values[DenseIndex] = std::move(Values[LastIndex]);
+			DenseToSlot[DenseIndex] = DenseToSlot[LastIndex];
+			Slots[DenseToSlot[DenseIndex]].DenseIndex = DenseIndex;
+		}
+
+		Values.pop_back();
+		DenseToSlot.pop_back();
+
+		//Bumping the generation is what invalidates every outstanding handle to this slot
+		Slot& Freed = Slots[SlotHandle.Index];
+		Freed.Generation++;
+		Freed.DenseIndex = FreeHead;
+		FreeHead = SlotHandle.Index;
+		return true;
+	}
+
+	[[nodiscard]] bool Contains(Handle SlotHandle) const
+	{
+		return SlotHandle.Index < Slots.size() && Slots[SlotHandle.Index].Generation == SlotHandle.Generation;
+	}
+
+	[[nodiscard]] T* Get(Handle SlotHandle)
+	{
+		return Contains(SlotHandle) ? std::addressof(Values[Slots[SlotHandle.Index].DenseIndex]) : nullptr;
+	}
+
+	[[nodiscard]] const T* Get(Handle SlotHandle) const
+	{
+		return Contains(SlotHandle) ? std::addressof(Values[Slots[SlotHandle.Index].DenseIndex]) : nullptr;
+	}
+
+	//Handle of the value currently stored at a dense position, only valid until the next Erase
+	[[nodiscard]] Handle GetHandle(size_t DenseIndex) const
+	{
+		const uint32_t SlotIndex = DenseToSlot[DenseIndex];
+		return { SlotIndex, Slots[SlotIndex].Generation };
+	}
+
+	void Reserve(size_t Count)
+	{
+		Values.reserve(Count);
+		DenseToSlot.reserve(Count);
+		Slots.reserve(Count);
+	}
+
+	//Frees every slot like Erase does, the slots stay so handles from before the clear can never become valid again
+	void Clear()
+	{
+		for (uint32_t SlotIndex : DenseToSlot) {
+			Slot& Freed = Slots[SlotIndex];
+			Freed.Generation++;
+			Freed.DenseIndex = FreeHead;
+			FreeHead = SlotIndex;
+		}
+
+		Values.clear();
+		DenseToSlot.clear();
+	}
+
+	[[nodiscard]] size_t Size() const { return Values.size(); }
+	[[nodiscard]] bool Empty() const { return Values.empty(); }
+
+	[[nodiscard]] T& operator[](size_t DenseIndex) { return Values[DenseIndex]; }
+	[[nodiscard]] const T& operator[](size_t DenseIndex) const { return Values[DenseIndex]; }
+
+	[[nodiscard]] auto begin() { return Values.begin(); }
+	[[nodiscard]] auto end() { return Values.end(); }
+	[[nodiscard]] auto begin() const { return Values.begin(); }
+	[[nodiscard]] auto end() const { return Values.end(); }
+
+private:
+	struct Slot
+	{
+		uint32_t DenseIndex = 0;  //Next free slot while the slot is on the free list
+		uint32_t Generation = 0;
+	};
+
+	std::vector<T> Values{};
+	std::vector<uint32_t> DenseToSlot{};
+	std::vector<Slot> Slots{};
+	uint32_t FreeHead = UINT32_MAX;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//Copy of per actor state published once per frame, readable from any thread without a lock (sequence lock).
+//The writer fills Stage(), then Publish() sorts it by key and copies it into the published array between two sequence bumps.
+//Readers binary search the published array and retry if a publish ran while they were reading, so they never block the writer.
+//Entries need a uint32_t Key and have to be trivially copyable. Only one thread may ever publish.
+template <class T, size_t Capacity>
+class SnapshotTable
+{
+	static_assert(std::is_trivially_copyable_v<T>, "Entries are copied while the writer may be overwriting them");
+
+public:
+	SnapshotTable() :
+		Published(std::make_unique<T[]>(Capacity))
+	{
+		Staged.reserve(Capacity);
+	}
+
+	SnapshotTable(const SnapshotTable&) = delete;
+	SnapshotTable& operator=(const SnapshotTable&) = delete;
+
+	//Writer side
+	std::vector<T>& Stage()
+	{
+		Staged.clear();
+		return Staged;
+	}
+
+	void Publish(uint64_t Frame)
+	{
+		std::sort(Staged.begin(), Staged.end(), [](const T& A, const T& B) { return A.Key < B.Key; });
+		const size_t NewCount = std::min(Staged.size(), Capacity);
+		Dropped = Staged.size() - NewCount;
+
+		const uint64_t Start = Sequence.load(std::memory_order_relaxed);
+		Sequence.store(Start + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		if (NewCount) std::memcpy(Published.get(), Staged.data(), NewCount * sizeof(T));
+		Count.store(NewCount, std::memory_order_relaxed);
+		PublishedFrame.store(Frame, std::memory_order_relaxed);
+
+		Sequence.store(Start + 2, std::memory_order_release);
+	}
+
+	//Entries that did not fit in the last publish
+	[[nodiscard]] size_t DroppedCount() const { return Dropped; }
+
+	//Reader side, any thread. False if Key was not in the last publish
+	bool Find(uint32_t Key, T& OutEntry, uint64_t& OutFrame) const
+	{
+		for (uint32_t Attempt = 0;; Attempt++) {
+			const uint64_t Before = Sequence.load(std::memory_order_acquire);
+			if (Before & 1) {
+				Backoff(Attempt);
+				continue;
+			}
+
+			const size_t Size = std::min(Count.load(std::memory_order_relaxed), Capacity);
+			const T* Begin = Published.get();
+			const T* End = Begin + Size;
+			const T* Found = std::lower_bound(Begin, End, Key, [](const T& Entry, uint32_t Value) { return Entry.Key < Value; });
+
+			bool Hit = Found != End && Found->Key == Key;
+			if (Hit) std::memcpy(&OutEntry, Found, sizeof(T));
+			OutFrame = PublishedFrame.load(std::memory_order_relaxed);
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (Sequence.load(std::memory_order_relaxed) == Before) return Hit;
+
+			Backoff(Attempt);
+		}
+	}
+
+private:
+	static void Backoff(uint32_t Attempt)
+	{
+		//A publish only holds the sequence for one copy of the entries, only give up the time slice if it takes unusually long
+		if (Attempt >= 16) std::this_thread::yield();
+	}
+
+	std::unique_ptr<T[]> Published;
+	std::vector<T> Staged{};
+	size_t Dropped = 0;
+
+	alignas(64) std::atomic<uint64_t> Sequence{ 0 };
+	std::atomic<size_t> Count{ 0 };
+	std::atomic<uint64_t> PublishedFrame{ 0 };
+};
@@ -0,0 +1,62 @@
+#include "Stats.h"
+#include "Settings.h"
+
+void Stats::EndFrame() {
+	LastFrame = Frame;
+	Frame = {};
+	FrameIndex++;
+
+	if (Settings::bLogStatistics && FrameIndex % LogInterval == 0) {
+		Log();
+	}
+}
+
+//True while the frame that is about to end is going to be logged, for counters that are too expensive to fill every frame
+bool Stats::WillLog() {
+	return Settings::bLogStatistics && (FrameIndex + 1) % LogInterval == 0;
+}
+
+void Stats::Log() {
+	logger::info("[Stats] Frame {}: Controllers {} Frozen {} | Rebuilds Convex {} Capsule {} Skipped {} | Jobs {} Deferred {} | Update {:.1f}us | Compute {:.1f}us | WorldLock {}x {:.1f}us | Hulls Specialized {} Generic {} | Shapes Allocated {} Recycled {} Rewritten {} | ShapeCache Hit {} Miss {} Evict {} | Interned Hit {} Shapes {} Users {} Ratio {:.2f} Saved {}KB | Bone Lookups {} | Shape Lookups {} | Creature Clones {} {}KB Hit {} Created {} Evict {} | Pushed Scales {} | Clearance Queries {} Cached {} Rays {} | Sneak Clearance {:.1f}Hz Refreshed {} Stalest {:.0f}ms | Stand Checks {} Held {}",
+		FrameIndex,
+		LastFrame.Controllers,
+		LastFrame.FrozenControllers,
+		LastFrame.ConvexRebuilds,
+		LastFrame.CapsuleRebuilds,
+		LastFrame.SkippedRebuilds,
+		LastFrame.ScheduledJobs,
+		LastFrame.DeferredJobs,
+		LastFrame.UpdateMicroseconds,
+		LastFrame.ComputeMicroseconds,
+		LastFrame.WorldLocks,
+		LastFrame.WorldLockMicroseconds,
+		LastFrame.SpecializedHulls,
+		LastFrame.GenericHulls,
+		LastFrame.ShapeAllocations,
+		LastFrame.ShapesRecycled,
+		LastFrame.ShapesRewritten,
+		LastFrame.ShapeCacheHits,
+		LastFrame.ShapeCacheMisses,
+		LastFrame.ShapeCacheEvictions,
+		LastFrame.InternHits,
+		LastFrame.InternedShapes,
+		LastFrame.InternUsers,
+		LastFrame.InternedShapes ? static_cast<float>(LastFrame.InternUsers) / static_cast<float>(LastFrame.InternedShapes) : 0.f,
+		LastFrame.InternBytesSaved / 1024,
+		LastFrame.BoneResolves,
+		LastFrame.ShapeLookups,
+		LastFrame.CreatureClones,
+		LastFrame.CreatureCloneBytes / 1024,
+		LastFrame.CreatureCloneHits,
+		LastFrame.CreatureClonesCreated,
+		LastFrame.CreatureCloneEvictions,
+		LastFrame.PushedScales,
+		LastFrame.ClearanceQueries,
+		LastFrame.ClearanceCacheHits,
+		LastFrame.ClearanceRays,
+		LastFrame.SneakClearanceHz,
+		LastFrame.ClearanceRefreshes,
+		LastFrame.ClearanceStalestMilliseconds,
+		LastFrame.StandChecks,
+		LastFrame.StandHeld);
+}
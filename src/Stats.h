@@ -0,0 +1,57 @@
+#pragma once
+
+//Per frame counters, filled on the main thread during AdjustmentHandler::Update
+struct Stats {
+	struct FrameCounters {
+		uint32_t Controllers = 0;
+		uint32_t FrozenControllers = 0;
+		uint32_t ConvexRebuilds = 0;
+		uint32_t CapsuleRebuilds = 0;
+		uint32_t SkippedRebuilds = 0;
+		uint32_t ScheduledJobs = 0;
+		uint32_t DeferredJobs = 0;
+		float UpdateMicroseconds = 0.f;
+		uint32_t WorldLocks = 0;
+		float WorldLockMicroseconds = 0.f;  //Time spent holding havok world write locks in the commit phase
+		float ComputeMicroseconds = 0.f;    //Wall time of the parallel shape math
+		uint32_t SpecializedHulls = 0;
+		uint32_t GenericHulls = 0;
+		uint32_t ShapeAllocations = 0;  //Shapes that came from havok's heap, without recycling this would be all three
+		uint32_t ShapesRecycled = 0;
+		uint32_t ShapesRewritten = 0;
+		uint32_t ShapeCacheHits = 0;
+		uint32_t ShapeCacheMisses = 0;
+		uint32_t ShapeCacheEvictions = 0;
+		uint32_t InternHits = 0;
+		uint32_t InternedShapes = 0;  //Only filled on frames that get logged
+		uint32_t InternUsers = 0;
+		uint64_t InternBytesSaved = 0;
+		uint32_t BoneResolves = 0;  //Skeleton searches, only happens when an actor's 3D changed
+		uint32_t ShapeLookups = 0;  //Shape tree walks, only happens when a controller's shapes changed
+		uint32_t CreatureCloneHits = 0;
+		uint32_t CreatureClonesCreated = 0;
+		uint32_t CreatureCloneEvictions = 0;
+		uint32_t CreatureClones = 0;  //Live clones held by the clone cache
+		uint64_t CreatureCloneBytes = 0;
+		uint32_t PushedScales = 0;  //Controllers whose scale came from the api instead of their nodes
+		uint32_t ClearanceQueries = 0;
+		uint32_t ClearanceCacheHits = 0;
+		uint32_t ClearanceRays = 0;
+		uint32_t ClearanceRefreshes = 0;           //Background checks of sneaking actors
+		float SneakClearanceHz = 0.f;              //How often every sneaking actor is due a background check
+		float ClearanceStalestMilliseconds = 0.f;  //Oldest answer a sneaking actor had before this frame's refreshes
+		uint32_t StandChecks = 0;                  //Held npc's cast this frame, the rest reused an earlier answer
+		uint32_t StandHeld = 0;                    //Npc's whose stand up or growth is held back for lack of room
+	};
+
+	static void EndFrame();
+	static bool WillLog();
+	static void Log();
+
+	static inline FrameCounters Frame{};      //The frame currently being processed
+	static inline FrameCounters LastFrame{};  //The last completed frame
+	static inline uint64_t FrameIndex = 0;
+
+	//How often the counters get written to the log when bLogStatistics is enabled
+	static constexpr uint64_t LogInterval = 300;
+};
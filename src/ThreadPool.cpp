@@ -0,0 +1,124 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+void ThreadPool::Resize(uint32_t RequestedWorkers) {
+	uint32_t Target = RequestedWorkers;
+	if (Target == 0) {
+		//The game already keeps a handful of threads busy, only take a quarter of what is there
+		const uint32_t Hardware = std::max(std::thread::hardware_concurrency(), 1u);
+		Target = std::clamp(Hardware / 4u, 1u, 4u);
+	}
+
+	if (Target == Threads.size()) return;
+
+	Stop();
+
+	Queues.reserve(Target);
+	for (uint32_t i = 0; i < Target; i++) {
+		Queues.emplace_back(std::make_unique<WorkQueue>());
+	}
+
+	Threads.reserve(Target);
+	for (uint32_t i = 0; i < Target; i++) {
+		Threads.emplace_back(&ThreadPool::WorkerLoop, this, static_cast<size_t>(i));
+	}
+
+	logger::info("ThreadPool: Started {} worker threads", Target);
+}
+
+void ThreadPool::Stop() {
+	if (Threads.empty()) return;
+
+	{
+		std::lock_guard<std::mutex> Guard(SleepLock);
+		Stopping = true;
+	}
+	WakeUp.notify_all();
+
+	for (std::thread& Worker : Threads) {
+		if (Worker.joinable()) Worker.join();
+	}
+
+	Threads.clear();
+	Queues.clear();
+	Queued.store(0, std::memory_order_relaxed);
+	Stopping = false;
+}
+
+void ThreadPool::Submit(Batch& Work, size_t Count, size_t Grain) {
+	const size_t TaskCount = (Count + Grain - 1) / Grain;
+	Work.Remaining.store(TaskCount, std::memory_order_relaxed);
+
+	//Round robin, every worker starts out with its own share and only steals once that is gone
+	for (size_t i = 0; i < TaskCount; i++) {
+		const size_t Begin = i * Grain;
+		WorkQueue& Queue = *Queues[i % Queues.size()];
+		std::lock_guard<std::mutex> Guard(Queue.Lock);
+		Queue.Tasks.push_back({ &Work, Begin, std::min(Begin + Grain, Count) });
+	}
+
+	Queued.fetch_add(TaskCount, std::memory_order_release);
+
+	//Taking the lock orders the counter update before a sleeping worker re-checks it
+	{ std::lock_guard<std::mutex> Guard(SleepLock); }
+	WakeUp.notify_all();
+}
+
+void ThreadPool::WaitFor(Batch& Work) {
+	size_t Home = 0;
+	while (Work.Remaining.load(std::memory_order_acquire) != 0) {
+		Task Job;
+		if (TryTake(Home, Job)) {
+			Execute(Job);
+		} else {
+			std::this_thread::yield();
+		}
+		Home = (Home + 1) % Queues.size();
+	}
+}
+
+bool ThreadPool::TryTake(size_t Home, Task& OutTask) {
+	if (Queued.load(std::memory_order_acquire) == 0) return false;
+
+	for (size_t i = 0; i < Queues.size(); i++) {
+		WorkQueue& Queue = *Queues[(Home + i) % Queues.size()];
+		std::lock_guard<std::mutex> Guard(Queue.Lock);
+		if (Queue.Tasks.empty()) continue;
+
+		//Own queue from the back (still warm), others from the front
+		if (i == 0) {
+			OutTask = Queue.Tasks.back();
+			Queue.Tasks.pop_back();
+		} else {
+			OutTask = Queue.Tasks.front();
+			Queue.Tasks.pop_front();
+		}
+
+		Queued.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	return false;
+}
+
+void ThreadPool::Execute(const Task& Job) {
+	for (size_t i = Job.Begin; i < Job.End; i++) {
+		Job.Owner->Invoke(Job.Owner->Context, i);
+	}
+	Job.Owner->Remaining.fetch_sub(1, std::memory_order_release);
+}
+
+void ThreadPool::WorkerLoop(size_t Index) {
+	for (;;) {
+		Task Job;
+		if (TryTake(Index, Job)) {
+			Execute(Job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> Guard(SleepLock);
+		WakeUp.wait(Guard, [this]() { return Stopping || Queued.load(std::memory_order_acquire) != 0; });
+		if (Stopping) return;
+	}
+}
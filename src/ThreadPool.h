@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//Small work stealing pool for the per controller shape math.
+//Every worker owns a queue and takes from its back, a worker that runs dry steals from the front of the others.
+//The thread calling ParallelFor helps out until its batch is done, so with no workers everything simply runs inline.
+//Nothing that touches the game or havok may run on the workers, only plain math on data gathered beforehand.
+class ThreadPool
+{
+public:
+	static ThreadPool* GetSingleton()
+	{
+		//Never destroyed on purpose, joining threads while the dll gets unloaded can deadlock on the loader lock
+		static ThreadPool* Singleton = new ThreadPool();
+		return Singleton;
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	//Restarts the workers if the count changed. 0 picks a count that leaves most cores to the game.
+	//Must not be called while a ParallelFor is running
+	void Resize(uint32_t RequestedWorkers);
+	void Stop();
+
+	[[nodiscard]] size_t WorkerCount() const { return Threads.size(); }
+
+	//Calls Fn(Index) for every index in [0, Count), Grain indices per task. Returns once all of them ran
+	template <class Func>
+	void ParallelFor(size_t Count, size_t Grain, Func&& Fn)
+	{
+		if (Count == 0) return;
+		if (Grain == 0) Grain = 1;
+
+		if (Threads.empty() || Count <= Grain) {
+			for (size_t i = 0; i < Count; i++) {
+				Fn(i);
+			}
+			return;
+		}
+
+		using FuncType = std::remove_reference_t<Func>;
+		Batch Work{};
+		Work.Context = const_cast<void*>(static_cast<const void*>(std::addressof(Fn)));
+		Work.Invoke = [](void* Context, size_t Index) {
+			(*static_cast<FuncType*>(Context))(Index);
+		};
+
+		Submit(Work, Count, Grain);
+		WaitFor(Work);
+	}
+
+private:
+	struct Batch
+	{
+		void (*Invoke)(void*, size_t) = nullptr;
+		void* Context = nullptr;
+		std::atomic<size_t> Remaining{ 0 };  //Tasks of this batch that have not finished yet
+	};
+
+	struct Task
+	{
+		Batch* Owner;
+		size_t Begin;
+		size_t End;
+	};
+
+	struct alignas(64) WorkQueue
+	{
+		std::mutex Lock;
+		std::deque<Task> Tasks;
+	};
+
+	ThreadPool() = default;
+
+	void Submit(Batch& Work, size_t Count, size_t Grain);
+	void WaitFor(Batch& Work);
+	bool TryTake(size_t Home, Task& OutTask);
+	void WorkerLoop(size_t Index);
+
+	static void Execute(const Task& Job);
+
+	std::vector<std::unique_ptr<WorkQueue>> Queues{};
+	std::vector<std::thread> Threads{};
+
+	std::mutex SleepLock;
+	std::condition_variable WakeUp;
+	std::atomic<size_t> Queued{ 0 };
+	bool Stopping = false;
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Offsets.h"
+#include "SkeletonIndex.h"
 
 namespace Utils
 {
@@ -158,9 +159,27 @@ namespace Utils
 	void ToggleCharacterBumper(RE::Actor* a_actor, bool a_bEnable);
 
 	//TODO All of this should really be an API call into th gts dll..
+	//Plugins can push their scales through DynamicCollisionAdjustmentAPI.h now, the node reads here stay for everything else
 
 	[[nodiscard]] RE::hkVector4 GetBoneQuad(const RE::Actor* a_actor, const char* a_boneStr, bool a_invert, bool a_worldtranslate);
 
+	struct NiSkeletonTraits
+	{
+		static const char* Name(RE::NiAVObject* a_node) { return a_node->name.c_str(); }
+
+		template <class Fn>
+		static void ForEachChild(RE::NiAVObject* a_node, Fn&& a_callback)
+		{
+			if (const auto ninode = a_node->AsNode()) {
+				for (const auto& child : ninode->GetChildren()) {
+					a_callback(child.get());
+				}
+			}
+		}
+	};
+
+	using NiSkeletonIndex = SkeletonIndex<RE::NiAVObject, NiSkeletonTraits>;
+
 	[[nodiscard]] RE::NiAVObject* FindBoneNode(const RE::Actor* a_actorptr, std::string_view a_nodeName, bool a_isFirstPerson);
 
 	[[nodiscard]] inline float soft_power(const float x, const float k, const float n, const float s, const float o, const float a)
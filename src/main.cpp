@@ -1,4 +1,5 @@
 #include "Hooks.h"
+#include "ModAPI.h"
 #include "Papyrus.h"
 #include "Settings.h"
 
@@ -65,6 +66,22 @@ extern "C" DLLEXPORT bool SKSEAPI SKSEPlugin_Query(const SKSE::QueryInterface* a
 	return true;
 }
 
+extern "C" DLLEXPORT void* SKSEAPI RequestPluginAPI(const DCA_API::InterfaceVersion a_interfaceVersion) {
+	auto api = ModAPI::GetSingleton();
+
+	logger::info("RequestPluginAPI called, InterfaceVersion {}", static_cast<uint8_t>(a_interfaceVersion) + 1);
+
+	switch (a_interfaceVersion) {
+		case DCA_API::InterfaceVersion::V1:
+		case DCA_API::InterfaceVersion::V2:
+			logger::info("RequestPluginAPI returned the API singleton");
+			return static_cast<void*>(api);
+	}
+
+	logger::info("RequestPluginAPI requested the wrong interface version");
+	return nullptr;
+}
+
 extern "C" DLLEXPORT constinit auto SKSEPlugin_Version = []() {
 	SKSE::PluginVersionData v;
 
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+//Timing for the benchmarks. Every measurement is the best of a few runs, the others mostly measure the scheduler
+namespace Bench
+{
+	//--quick runs every benchmark a handful of times, enough for ctest to see that it works
+	inline bool IsQuick(int ArgCount, char** Args)
+	{
+		for (int i = 1; i < ArgCount; i++) {
+			if (std::strcmp(Args[i], "--quick") == 0) return true;
+		}
+		return false;
+	}
+
+	//Nanoseconds per iteration of Fn(Iteration)
+	template <class Func>
+	double Measure(size_t Iterations, Func&& Fn, int Runs = 5)
+	{
+		double Best = 0.;
+		for (int Run = 0; Run < Runs; Run++) {
+			const auto Start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < Iterations; i++) {
+				Fn(i);
+			}
+			const double Elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count() / static_cast<double>(Iterations);
+			Best = Run == 0 ? Elapsed : std::min(Best, Elapsed);
+		}
+		return Best;
+	}
+
+	inline volatile uint64_t Sink = 0;
+
+	//Keeps the optimizer from dropping work whose result is never used
+	template <class T>
+	inline void Consume(const T& Value)
+	{
+		uint64_t Bits = 0;
+		std::memcpy(&Bits, &Value, std::min(sizeof(T), sizeof(Bits)));
+		Sink = Sink + Bits;
+	}
+}
@@ -0,0 +1,243 @@
+#include "CapsuleKernel.h"
+#include "Check.h"
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+//The kernel against the per controller loops it replaced, and every vector path against the scalar one. Batches of every
+//size up to a few vectors wide so the SSE4.1 and AVX2 tails get hit, with clamped and unclamped capsules mixed in every batch
+namespace
+{
+	constexpr size_t Batches = 20000;
+
+	//hkpCapsuleShape's parts the loops touched, x and w were never changed
+	struct OldCapsule
+	{
+		float Radius;
+		float A[4];
+		float B[4];
+	};
+
+	//ComputeProxyCapsule before the kernel, the top vertex goes to the head and never below the bottom one
+	OldCapsule OldTracked(const OldCapsule& Original, float ActorScale, float HeadZ)
+	{
+		OldCapsule Target = Original;
+		Target.Radius = Original.Radius * ActorScale * 0.8f;
+
+		const float GroundOffset = -Original.Radius + Target.Radius;  //Utils::SphereOffset
+		Target.B[2] = Original.B[2] + GroundOffset;
+
+		const float TargetZ = HeadZ - Original.A[2];
+		const float BottomZ = Target.B[2];
+		Target.A[2] = TargetZ < BottomZ ? BottomZ + 0.01f : TargetZ;
+
+		Target.A[1] = Original.A[1] * ActorScale;
+		Target.B[1] = Original.B[1] * ActorScale;
+		return Target;
+	}
+
+	//ComputeProxyCapsuleSimple before the kernel, the top vertex just scales
+	OldCapsule OldSimple(const OldCapsule& Original, float ActorScale)
+	{
+		OldCapsule Target = Original;
+		Target.Radius = Original.Radius * ActorScale * 0.8f;
+
+		const float GroundOffset = -Original.Radius + Target.Radius;
+		Target.B[2] = Original.B[2] + GroundOffset;
+		Target.A[2] = Original.A[2] * ActorScale;
+
+		Target.A[1] = Original.A[1] * ActorScale;
+		Target.B[1] = Original.B[1] * ActorScale;
+		return Target;
+	}
+
+	struct Input
+	{
+		OldCapsule Original;
+		CapsuleKernel::Params Adjust;
+	};
+
+	//Capsules shaped roughly like an actor's, the head sometimes low enough for the clamp to kick in
+	Input MakeInput(std::mt19937& Random)
+	{
+		std::uniform_real_distribution<float> Radius(0.05f, 0.6f);
+		std::uniform_real_distribution<float> Offset(-0.5f, 0.5f);
+		std::uniform_real_distribution<float> Height(0.2f, 1.8f);
+		std::uniform_real_distribution<float> Scale(0.15f, 4.f);
+		std::uniform_int_distribution<int> Coin(0, 1);
+
+		Input Out{};
+		Out.Original.Radius = Radius(Random);
+		Out.Original.A[0] = Offset(Random);
+		Out.Original.A[1] = Offset(Random);
+		Out.Original.A[2] = Height(Random);
+		Out.Original.A[3] = 0.f;
+		Out.Original.B[0] = Offset(Random);
+		Out.Original.B[1] = Offset(Random);
+		Out.Original.B[2] = Offset(Random);
+		Out.Original.B[3] = 0.f;
+
+		Out.Adjust.Scale = Scale(Random);
+		if (Coin(Random)) {
+			Out.Adjust.HeadZ = Height(Random) * 2.f - 1.5f;
+			Out.Adjust.ZScale = -1.f;
+			Out.Adjust.ClampToBottom = true;
+		} else {
+			Out.Adjust.HeadZ = 0.f;
+			Out.Adjust.ZScale = Out.Adjust.Scale;
+			Out.Adjust.ClampToBottom = false;
+		}
+		return Out;
+	}
+
+	CapsuleKernel::Capsule AsKernel(const OldCapsule& Capsule)
+	{
+		return { Capsule.Radius, Capsule.A[1], Capsule.A[2], Capsule.B[1], Capsule.B[2] };
+	}
+
+	bool SameBits(const CapsuleKernel::Capsule& A, const CapsuleKernel::Capsule& B)
+	{
+		return std::memcmp(&A, &B, sizeof(A)) == 0;
+	}
+
+	//+0 and -0 count as equal, 0 + -0 in the kernel's simple path gives +0 where the old loop kept the sign
+	bool SameValues(const CapsuleKernel::Capsule& A, const CapsuleKernel::Capsule& B)
+	{
+		return A.Radius == B.Radius && A.AY == B.AY && A.AZ == B.AZ && A.BY == B.BY && A.BZ == B.BZ;
+	}
+
+	const char* LevelName(RingKernel::Level Path)
+	{
+		switch (Path) {
+			case RingKernel::Level::kAVX2:
+				return "AVX2";
+			case RingKernel::Level::kSSE41:
+				return "SSE4.1";
+			default:
+				return "scalar";
+		}
+	}
+
+	//Every path the machine has, against both old loops. The kernel does the same operations in the same order
+	void TestAgainstOldLoops()
+	{
+		const RingKernel::Level Supported = RingKernel::SupportedLevel();
+
+		for (RingKernel::Level Path : { RingKernel::Level::kScalar, RingKernel::Level::kSSE41, RingKernel::Level::kAVX2 }) {
+			if (Path > Supported) {
+				std::printf("%s not supported here, skipped\n", LevelName(Path));
+				continue;
+			}
+
+			std::mt19937 Random(4321);
+			CapsuleKernel::Batch Batch;
+			uint64_t Capsules = 0;
+			uint64_t Mismatches = 0;
+			uint64_t Clamped = 0;
+
+			for (size_t b = 0; b < Batches / 8; b++) {
+				std::vector<Input> Inputs(std::uniform_int_distribution<size_t>(1, 40)(Random));
+				Batch.Clear();
+				for (Input& Each : Inputs) {
+					Each = MakeInput(Random);
+					Batch.Add(AsKernel(Each.Original), Each.Adjust);
+				}
+				Batch.Run(Path);
+
+				for (size_t i = 0; i < Inputs.size(); i++) {
+					const Input& Each = Inputs[i];
+					const OldCapsule Old = Each.Adjust.ClampToBottom ? OldTracked(Each.Original, Each.Adjust.Scale, Each.Adjust.HeadZ) : OldSimple(Each.Original, Each.Adjust.Scale);
+					Mismatches += !SameValues(Batch.Get(i), AsKernel(Old));
+					Clamped += Each.Adjust.ClampToBottom && Each.Adjust.HeadZ - Each.Original.A[2] < Old.B[2];
+					Capsules++;
+				}
+			}
+
+			CHECK(Mismatches == 0);
+			CHECK(Clamped > 0);
+			std::printf("%s against the old loops: %llu of %llu capsules differ, %llu clamped\n", LevelName(Path), static_cast<unsigned long long>(Mismatches),
+				static_cast<unsigned long long>(Capsules), static_cast<unsigned long long>(Clamped));
+		}
+	}
+
+	//Every batch size from 1 to a few vectors wide, so each path runs its full vectors, its tail and the next level's tail.
+	//Clamped lanes sit next to unclamped ones whose target is below the bottom too, only the mask may tell them apart
+	void TestVectorPaths()
+	{
+		const RingKernel::Level Supported = RingKernel::SupportedLevel();
+		std::mt19937 Random(8765);
+
+		for (RingKernel::Level Path : { RingKernel::Level::kSSE41, RingKernel::Level::kAVX2 }) {
+			if (Path > Supported) {
+				std::printf("%s not supported here, skipped\n", LevelName(Path));
+				continue;
+			}
+
+			uint64_t Mismatches = 0;
+			uint64_t BelowUnclamped = 0;
+			CapsuleKernel::Batch Scalar;
+			CapsuleKernel::Batch Vector;
+
+			for (size_t Size = 1; Size <= 35; Size++) {
+				for (size_t b = 0; b < Batches / 35; b++) {
+					Scalar.Clear();
+					Vector.Clear();
+					for (size_t i = 0; i < Size; i++) {
+						Input Each = MakeInput(Random);
+						//Same head for both kinds, so unclamped lanes end up below the bottom as often as clamped ones
+						if (std::uniform_int_distribution<int>(0, 3)(Random) == 0) {
+							Each.Adjust.HeadZ = -1.5f;
+							Each.Adjust.ZScale = -1.f;
+						}
+						BelowUnclamped += !Each.Adjust.ClampToBottom && Each.Adjust.HeadZ < 0.f;
+
+						Scalar.Add(AsKernel(Each.Original), Each.Adjust);
+						Vector.Add(AsKernel(Each.Original), Each.Adjust);
+					}
+
+					Scalar.Run(RingKernel::Level::kScalar);
+					Vector.Run(Path);
+					for (size_t i = 0; i < Size; i++) {
+						Mismatches += !SameBits(Scalar.Get(i), Vector.Get(i));
+					}
+				}
+			}
+
+			CHECK(Mismatches == 0);
+			CHECK(BelowUnclamped > 0);
+			std::printf("%s against scalar: %llu mismatching capsules\n", LevelName(Path), static_cast<unsigned long long>(Mismatches));
+		}
+	}
+
+	//Clear keeps the storage but a smaller batch after a bigger one must not read the old inputs
+	void TestReuse()
+	{
+		std::mt19937 Random(99);
+		CapsuleKernel::Batch Batch;
+		for (size_t i = 0; i < 19; i++) {
+			const Input Each = MakeInput(Random);
+			Batch.Add(AsKernel(Each.Original), Each.Adjust);
+		}
+		Batch.Run();
+
+		Batch.Clear();
+		CHECK(Batch.Size() == 0);
+
+		const Input Each = MakeInput(Random);
+		CHECK(Batch.Add(AsKernel(Each.Original), Each.Adjust) == 0);
+		Batch.Run();
+
+		const OldCapsule Old = Each.Adjust.ClampToBottom ? OldTracked(Each.Original, Each.Adjust.Scale, Each.Adjust.HeadZ) : OldSimple(Each.Original, Each.Adjust.Scale);
+		CHECK(SameValues(Batch.Get(0), AsKernel(Old)));
+	}
+}
+
+int main()
+{
+	TestAgainstOldLoops();
+	TestVectorPaths();
+	TestReuse();
+	return Check::Finish("CapsuleKernelTests");
+}
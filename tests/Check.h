@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdio>
+
+//Just enough of a test framework for the header tests, a failed check is printed and the test keeps going
+namespace Check
+{
+	inline int Failures = 0;
+
+	inline void Fail(const char* Expression, const char* File, int Line)
+	{
+		std::printf("%s:%d: check failed: %s\n", File, Line, Expression);
+		Failures++;
+	}
+
+	//Exit code for main
+	inline int Finish(const char* Name)
+	{
+		if (Failures) {
+			std::printf("%s: %d check(s) failed\n", Name, Failures);
+			return 1;
+		}
+
+		std::printf("%s: passed\n", Name);
+		return 0;
+	}
+}
+
+#define CHECK(Expression) ((Expression) ? (void)0 : Check::Fail(#Expression, __FILE__, __LINE__))
@@ -0,0 +1,47 @@
+#include "Bench.h"
+#include "Check.h"
+#include "ControllerHull.h"
+#include "ReferenceHull.h"
+#include "SyntheticHull.h"
+
+#include <vector>
+
+//The specialized builder against a general quickhull on the hulls a rebuild sees, a Standard18 hull at changing scales
+int main(int ArgCount, char** Args)
+{
+	const bool Quick = Bench::IsQuick(ArgCount, Args);
+
+	std::vector<std::vector<ControllerHull::Vector>> Hulls;
+	for (int i = 0; i < 64; i++) {
+		SyntheticHull::Shape Params{};
+		const float Scale = 0.5f + static_cast<float>(i) * 0.1f;
+		Params.Radius *= Scale;
+		Params.BottomZ *= Scale;
+		Params.TopZ *= Scale;
+		Params.TopApexZ *= Scale;
+		Hulls.push_back(SyntheticHull::Make(ControllerHull::Standard18, Params));
+	}
+
+	const size_t Iterations = Quick ? 64 : 200000;
+
+	ControllerHull::Result Hull{};
+	uint32_t Built = 0;
+	const double Specialized = Bench::Measure(Iterations, [&](size_t i) {
+		const auto& Verts = Hulls[i % Hulls.size()];
+		Built += ControllerHull::Build(ControllerHull::Standard18, Verts.data(), Verts.size(), Hull);
+		Bench::Consume(Hull.Planes[0].W);
+	});
+	CHECK(Built > 0);
+
+	std::vector<ControllerHull::Vector> Planes;
+	uint32_t General = 0;
+	const double QuickHull = Bench::Measure(Iterations, [&](size_t i) {
+		const auto& Verts = Hulls[i % Hulls.size()];
+		General += ReferenceHull::QuickHull(Verts.data(), Verts.size(), Planes);
+		Bench::Consume(Planes.size());
+	});
+	CHECK(General > 0);
+
+	std::printf("Standard18 hull: specialized %.1fns, quickhull %.1fns (%.1fx)\n", Specialized, QuickHull, QuickHull / Specialized);
+	return Check::Finish("ControllerHullBench");
+}
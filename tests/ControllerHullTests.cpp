@@ -0,0 +1,301 @@
+#include "Check.h"
+#include "ControllerHull.h"
+#include "ReferenceHull.h"
+#include "SyntheticHull.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+	using ControllerHull::Vector;
+
+	//Both plane sets describe the same hull, in any order
+	bool SamePlanes(const std::vector<Vector>& Expected, const Vector* Actual, size_t ActualCount, float Tolerance = 1e-3f)
+	{
+		std::vector<Vector> Unique;
+		for (size_t i = 0; i < ActualCount; i++) {
+			ReferenceHull::AddUnique(Unique, Actual[i], Tolerance);
+		}
+		if (Unique.size() != Expected.size()) return false;
+
+		for (const Vector& Plane : Expected) {
+			const auto Found = std::find_if(Unique.begin(), Unique.end(), [&](const Vector& Other) { return ReferenceHull::SamePlane(Plane, Other, Tolerance); });
+			if (Found == Unique.end()) return false;
+		}
+		return true;
+	}
+
+	//Same apexes and the same ring pairs in the same angular order. Classify starts the rings at whichever vertex sorts
+	//first by angle, so any rotation of the expected rings counts
+	bool SameLayout(const ControllerHull::Topology& Expected, const ControllerHull::Topology& Actual)
+	{
+		if (Expected.TopApex != Actual.TopApex || Expected.BottomApex != Actual.BottomApex) return false;
+		if (Expected.RingSize != Actual.RingSize || Expected.VertexCount != Actual.VertexCount) return false;
+
+		const size_t RingSize = Expected.RingSize;
+		for (size_t Rotation = 0; Rotation < RingSize; Rotation++) {
+			bool Same = true;
+			for (size_t i = 0; i < RingSize && Same; i++) {
+				Same = Actual.BottomRing[i] == Expected.BottomRing[(i + Rotation) % RingSize] && Actual.TopRing[i] == Expected.TopRing[(i + Rotation) % RingSize];
+			}
+			if (Same) return true;
+		}
+		return false;
+	}
+
+	//Any ring size, ring vertices interleaved so neither ring is a contiguous index range
+	ControllerHull::Topology MakeLayout(size_t RingSize, bool TopApex, bool BottomApex)
+	{
+		ControllerHull::Topology Out{};
+		uint8_t Next = 0;
+		Out.BottomApex = BottomApex ? static_cast<int8_t>(Next++) : ControllerHull::NoApex;
+		for (size_t i = 0; i < RingSize; i++) {
+			Out.BottomRing[i] = Next++;
+			Out.TopRing[i] = Next++;
+		}
+		Out.TopApex = TopApex ? static_cast<int8_t>(Next++) : ControllerHull::NoApex;
+		Out.RingSize = static_cast<uint8_t>(RingSize);
+		Out.VertexCount = Next;
+		return Out;
+	}
+
+	//Turns the top ring about the up axis, the bottom one stays
+	void TwistTopRing(std::vector<Vector>& Verts, const ControllerHull::Topology& Layout, float Angle)
+	{
+		const float Cos = std::cos(Angle);
+		const float Sin = std::sin(Angle);
+		for (size_t i = 0; i < Layout.RingSize; i++) {
+			Vector& V = Verts[Layout.TopRing[i]];
+			V = { V.X * Cos - V.Y * Sin, V.X * Sin + V.Y * Cos, V.Z, 0.f };
+		}
+	}
+
+	bool Classifies(const ControllerHull::Topology& Layout, const std::vector<Vector>& Verts)
+	{
+		ControllerHull::Topology Found{};
+		return ControllerHull::Classify(Verts.data(), Verts.size(), Found) && SameLayout(Layout, Found);
+	}
+
+	bool Rejects(const std::vector<Vector>& Verts)
+	{
+		ControllerHull::Topology Found{};
+		return !ControllerHull::Classify(Verts.data(), Verts.size(), Found);
+	}
+
+	void CheckAgainstBruteForce(const ControllerHull::Topology& Layout, const SyntheticHull::Shape& Params)
+	{
+		const std::vector<Vector> Verts = SyntheticHull::Make(Layout, Params);
+
+		ControllerHull::Result Hull{};
+		CHECK(ControllerHull::Build(Layout, Verts.data(), Verts.size(), Hull));
+
+		const std::vector<Vector> Reference = ReferenceHull::BruteForce(Verts.data(), Verts.size());
+		CHECK(SamePlanes(Reference, Hull.Planes.data(), Hull.PlaneCount));
+
+		//The general builder has to agree too, otherwise the benchmark compares against the wrong thing
+		std::vector<Vector> QuickHull;
+		CHECK(ReferenceHull::QuickHull(Verts.data(), Verts.size(), QuickHull));
+		CHECK(SamePlanes(Reference, QuickHull.data(), QuickHull.size()));
+
+		Vector Min = Verts[0];
+		Vector Max = Verts[0];
+		for (const Vector& V : Verts) {
+			Min = { std::fmin(Min.X, V.X), std::fmin(Min.Y, V.Y), std::fmin(Min.Z, V.Z), 0.f };
+			Max = { std::fmax(Max.X, V.X), std::fmax(Max.Y, V.Y), std::fmax(Max.Z, V.Z), 0.f };
+		}
+
+		constexpr float Tolerance = 1e-6f;
+		CHECK(std::fabs(Hull.AabbCenter.X - (Min.X + Max.X) * 0.5f) <= Tolerance);
+		CHECK(std::fabs(Hull.AabbCenter.Y - (Min.Y + Max.Y) * 0.5f) <= Tolerance);
+		CHECK(std::fabs(Hull.AabbCenter.Z - (Min.Z + Max.Z) * 0.5f) <= Tolerance);
+		CHECK(std::fabs(Hull.AabbHalfExtents.X - (Max.X - Min.X) * 0.5f) <= Tolerance);
+		CHECK(std::fabs(Hull.AabbHalfExtents.Y - (Max.Y - Min.Y) * 0.5f) <= Tolerance);
+		CHECK(std::fabs(Hull.AabbHalfExtents.Z - (Max.Z - Min.Z) * 0.5f) <= Tolerance);
+
+		//Four vertices per block in order, the last block padded with the last vertex
+		CHECK(Hull.VertexCount == Verts.size());
+		CHECK(Hull.BlockCount == (Verts.size() + 3) / 4);
+		for (uint32_t b = 0; b < Hull.BlockCount; b++) {
+			for (size_t Lane = 0; Lane < 4; Lane++) {
+				const Vector& V = Verts[std::min<size_t>(b * 4 + Lane, Verts.size() - 1)];
+				CHECK(Hull.Blocks[b].X[Lane] == V.X && Hull.Blocks[b].Y[Lane] == V.Y && Hull.Blocks[b].Z[Lane] == V.Z);
+			}
+		}
+	}
+
+	void TestBuild()
+	{
+		CheckAgainstBruteForce(ControllerHull::Standard18, {});
+		CheckAgainstBruteForce(ControllerHull::Short17, {});
+
+		//Scaled the way the adjust paths do it, rotated and away from the origin
+		SyntheticHull::Shape Giant{};
+		Giant.Radius = 2.5f;
+		Giant.TopZ = 14.f;
+		Giant.TopApexZ = 16.f;
+		CheckAgainstBruteForce(ControllerHull::Standard18, Giant);
+
+		SyntheticHull::Shape Sneaking{};
+		Sneaking.TopZ = 0.9f;
+		Sneaking.TopApexZ = 1.1f;
+		Sneaking.AngleOffset = 0.3f;
+		Sneaking.OffsetX = 5.f;
+		Sneaking.OffsetY = -3.f;
+		CheckAgainstBruteForce(ControllerHull::Standard18, Sneaking);
+	}
+
+	void TestBuildRejects()
+	{
+		ControllerHull::Result Hull{};
+
+		//Wrong vertex count for the layout
+		const std::vector<Vector> Short = SyntheticHull::Make(ControllerHull::Short17);
+		CHECK(!ControllerHull::Build(ControllerHull::Standard18, Short.data(), Short.size(), Hull));
+
+		//Top apex pushed below the top ring, the cap folds into the hull
+		SyntheticHull::Shape Folded{};
+		Folded.TopApexZ = 1.f;
+		const std::vector<Vector> FoldedVerts = SyntheticHull::Make(ControllerHull::Standard18, Folded);
+		CHECK(!ControllerHull::Build(ControllerHull::Standard18, FoldedVerts.data(), FoldedVerts.size(), Hull));
+
+		//A ring vertex pulled in, the sides next to it are no longer convex
+		std::vector<Vector> Dented = SyntheticHull::Make(ControllerHull::Standard18);
+		Vector& Inner = Dented[ControllerHull::Standard18.TopRing[2]];
+		Inner = { Inner.X * 0.5f, Inner.Y * 0.5f, Inner.Z, 0.f };
+		CHECK(!ControllerHull::Build(ControllerHull::Standard18, Dented.data(), Dented.size(), Hull));
+	}
+
+	void TestClassify()
+	{
+		using ControllerHull::Standard18;
+		using ControllerHull::Short17;
+
+		CHECK(Classifies(Standard18, SyntheticHull::Make(Standard18)));
+		CHECK(Classifies(Short17, SyntheticHull::Make(Short17)));
+
+		//Odd ring sizes and the limits, with and without apexes
+		for (size_t RingSize : { 3, 5, 7, 9, 16 }) {
+			const ControllerHull::Topology Both = MakeLayout(RingSize, true, true);
+			const ControllerHull::Topology BottomOnly = MakeLayout(RingSize, false, true);
+			const ControllerHull::Topology Neither = MakeLayout(RingSize, false, false);
+			CHECK(Classifies(Both, SyntheticHull::Make(Both)));
+			CHECK(Classifies(BottomOnly, SyntheticHull::Make(BottomOnly)));
+			CHECK(Classifies(Neither, SyntheticHull::Make(Neither)));
+		}
+		CHECK(Rejects(SyntheticHull::Make(MakeLayout(2, true, true))));
+
+		//One vertex over MaxVertices
+		std::vector<Vector> TooMany = SyntheticHull::Make(MakeLayout(16, true, true));
+		TooMany.push_back(TooMany.back());
+		CHECK(Rejects(TooMany));
+	}
+
+	//A ring vertex right at +-pi: the top one lands just past it and sorts to the other end of its ring
+	void TestClassifyAngleWrap()
+	{
+		using ControllerHull::Standard18;
+		constexpr float Pi = 3.14159265f;
+
+		SyntheticHull::Shape AtPi{};
+		AtPi.AngleOffset = Pi - 0.01f;
+		std::vector<Vector> Verts = SyntheticHull::Make(Standard18, AtPi);
+		TwistTopRing(Verts, Standard18, 0.02f);
+		CHECK(Verts[Standard18.BottomRing[0]].Y > 0.f && Verts[Standard18.TopRing[0]].Y < 0.f);
+		CHECK(Classifies(Standard18, Verts));
+
+		for (size_t RingSize : { 3, 5, 16 }) {
+			const ControllerHull::Topology Layout = MakeLayout(RingSize, true, true);
+			std::vector<Vector> Wrapped = SyntheticHull::Make(Layout, AtPi);
+			TwistTopRing(Wrapped, Layout, 0.02f);
+			CHECK(Classifies(Layout, Wrapped));
+		}
+
+		//Twisted past AngleTolerance the rings no longer pair up
+		std::vector<Vector> Twisted = SyntheticHull::Make(Standard18);
+		TwistTopRing(Twisted, Standard18, 0.15f);
+		CHECK(Rejects(Twisted));
+	}
+
+	//Apexes have to be LevelTolerance (1% of the height) clear of their ring and within AxisTolerance (5% of the widest radius)
+	//of the up axis, anything else is a ring vertex and leaves an odd count
+	void TestClassifyApexes()
+	{
+		using ControllerHull::Standard18;
+		const SyntheticHull::Shape Default{};
+		const float LevelTolerance = (Default.TopApexZ - Default.BottomApexZ) * 0.01f;
+		const float AxisTolerance = Default.Radius * 0.05f;
+
+		SyntheticHull::Shape Clear{};
+		Clear.BottomApexZ = Default.BottomZ - LevelTolerance * 2.f;
+		Clear.TopApexZ = Default.TopZ + LevelTolerance * 2.f;
+		CHECK(Classifies(Standard18, SyntheticHull::Make(Standard18, Clear)));
+
+		SyntheticHull::Shape LowTop{};
+		LowTop.TopApexZ = Default.TopZ + LevelTolerance * 0.5f;
+		CHECK(Rejects(SyntheticHull::Make(Standard18, LowTop)));
+
+		SyntheticHull::Shape HighBottom{};
+		HighBottom.BottomApexZ = Default.BottomZ - LevelTolerance * 0.5f;
+		CHECK(Rejects(SyntheticHull::Make(Standard18, HighBottom)));
+
+		std::vector<Vector> NearAxis = SyntheticHull::Make(Standard18);
+		NearAxis[Standard18.TopApex].X = AxisTolerance * 0.5f;
+		NearAxis[Standard18.BottomApex].Y = -AxisTolerance * 0.5f;
+		CHECK(Classifies(Standard18, NearAxis));
+
+		std::vector<Vector> OffAxis = SyntheticHull::Make(Standard18);
+		OffAxis[Standard18.TopApex].X = AxisTolerance * 2.f;
+		CHECK(Rejects(OffAxis));
+
+		//The axis tolerance grows with the hull
+		SyntheticHull::Shape Giant{};
+		Giant.Radius = Default.Radius * 10.f;
+		std::vector<Vector> GiantNearAxis = SyntheticHull::Make(Standard18, Giant);
+		GiantNearAxis[Standard18.TopApex].X = AxisTolerance * 2.f;
+		CHECK(Classifies(Standard18, GiantNearAxis));
+
+		//Without the top apex the top ring is the highest level
+		const ControllerHull::Topology NoTop = MakeLayout(8, false, true);
+		CHECK(Classifies(NoTop, SyntheticHull::Make(NoTop)));
+	}
+
+	//Unclassifiable input falls back by vertex count, and only for the counts the game's controllers use
+	void TestResolve()
+	{
+		using ControllerHull::Standard18;
+		using ControllerHull::Short17;
+		ControllerHull::Topology Found{};
+
+		//Classify wins when it can, even if the count matches a known layout
+		const ControllerHull::Topology Interleaved = MakeLayout(8, true, true);
+		const std::vector<Vector> Classifiable = SyntheticHull::Make(Interleaved);
+		CHECK(ControllerHull::Resolve(Classifiable.data(), Classifiable.size(), Found) && SameLayout(Interleaved, Found));
+
+		std::vector<Vector> Flat18(18, Vector{ 0.1f, 0.2f, 0.5f, 0.f });
+		CHECK(Rejects(Flat18));
+		CHECK(ControllerHull::Resolve(Flat18.data(), Flat18.size(), Found));
+		CHECK(std::equal(Found.TopRing.begin(), Found.TopRing.end(), Standard18.TopRing.begin()) && Found.TopApex == Standard18.TopApex && Found.VertexCount == 18);
+
+		std::vector<Vector> Twisted17 = SyntheticHull::Make(Short17);
+		TwistTopRing(Twisted17, Short17, 0.3f);
+		CHECK(Rejects(Twisted17));
+		CHECK(ControllerHull::Resolve(Twisted17.data(), Twisted17.size(), Found));
+		CHECK(std::equal(Found.BottomRing.begin(), Found.BottomRing.end(), Short17.BottomRing.begin()) && Found.TopApex == ControllerHull::NoApex && Found.VertexCount == 17);
+
+		std::vector<Vector> Flat20(20, Vector{ 0.1f, 0.2f, 0.5f, 0.f });
+		CHECK(!ControllerHull::Resolve(Flat20.data(), Flat20.size(), Found));
+	}
+}
+
+int main()
+{
+	TestBuild();
+	TestBuildRejects();
+	TestClassify();
+	TestClassifyAngleWrap();
+	TestClassifyApexes();
+	TestResolve();
+	return Check::Finish("ControllerHullTests");
+}
@@ -0,0 +1,134 @@
+#include "Check.h"
+#include "EventQueue.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+//Many producers hammering a small queue while the consumer drains it, every producer's events have to come out complete and
+//in order. The queues are tiny on purpose so the ring fills up all the time
+namespace
+{
+	constexpr uint32_t Producers = 8;
+	constexpr uint32_t EventsPerProducer = 200000;
+
+	struct Event
+	{
+		uint32_t Producer;
+		uint32_t Sequence;
+	};
+
+	struct Tracker
+	{
+		std::vector<uint32_t> Next = std::vector<uint32_t>(Producers, 0);
+		uint64_t Received = 0;
+		uint64_t OutOfOrder = 0;
+
+		void Receive(const Event& Value)
+		{
+			if (Value.Producer >= Producers || Value.Sequence != Next[Value.Producer]) {
+				OutOfOrder++;
+			} else {
+				Next[Value.Producer]++;
+			}
+			Received++;
+		}
+
+		void CheckComplete() const
+		{
+			CHECK(OutOfOrder == 0);
+			CHECK(Received == static_cast<uint64_t>(Producers) * EventsPerProducer);
+			for (uint32_t i = 0; i < Producers; i++) {
+				CHECK(Next[i] == EventsPerProducer);
+			}
+		}
+	};
+
+	template <class Queue, class PushFn>
+	void Run(Queue& Events, PushFn Push, Tracker& Received)
+	{
+		std::atomic<uint32_t> Finished{ 0 };
+		std::vector<std::thread> Threads;
+		for (uint32_t Producer = 0; Producer < Producers; Producer++) {
+			Threads.emplace_back([&, Producer]() {
+				for (uint32_t Sequence = 0; Sequence < EventsPerProducer; Sequence++) {
+					Push(Events, Event{ Producer, Sequence });
+				}
+				Finished.fetch_add(1, std::memory_order_release);
+			});
+		}
+
+		const auto Receive = [&Received](const Event& Value) { Received.Receive(Value); };
+		while (Finished.load(std::memory_order_acquire) != Producers) {
+			if (Events.Drain(Receive) == 0) std::this_thread::yield();
+		}
+
+		for (std::thread& Thread : Threads) {
+			Thread.join();
+		}
+
+		//Once every producer is done a couple of drains empty whatever is left
+		while (Events.Drain(Receive) != 0) {}
+	}
+
+	//The bare ring rejects pushes while full, producers retry until theirs goes in
+	void TestRing()
+	{
+		EventQueue<Event, 64> Events;
+		Tracker Received;
+		std::atomic<uint64_t> Rejected{ 0 };
+
+		Run(Events, [&Rejected](EventQueue<Event, 64>& Queue, const Event& Value) {
+			while (!Queue.Push(Value)) {
+				Rejected.fetch_add(1, std::memory_order_relaxed);
+				std::this_thread::yield();
+			}
+		}, Received);
+
+		Received.CheckComplete();
+		CHECK(Events.Empty());
+		std::printf("Ring: %llu events, %llu rejected pushes retried\n", static_cast<unsigned long long>(Received.Received), static_cast<unsigned long long>(Rejected.load()));
+	}
+
+	//Pushes never fail, the overflow has to keep every producer's order across the ring and the spill
+	void TestSpilling()
+	{
+		SpillingEventQueue<Event, 16> Events;
+		Tracker Received;
+
+		Run(Events, [](SpillingEventQueue<Event, 16>& Queue, const Event& Value) { Queue.Push(Value); }, Received);
+
+		Received.CheckComplete();
+		std::printf("Spilling: %llu events\n", static_cast<unsigned long long>(Received.Received));
+	}
+
+	//Single threaded, the spill has to come out after what was already in the ring
+	void TestSpillOrder()
+	{
+		SpillingEventQueue<Event, 4> Events;
+		for (uint32_t i = 0; i < 10; i++) {
+			Events.Push({ 0, i });
+		}
+
+		std::vector<uint32_t> Order;
+		CHECK(Events.Drain([&Order](const Event& Value) { Order.push_back(Value.Sequence); }) == 10);
+		CHECK(Order.size() == 10);
+		for (uint32_t i = 0; i < Order.size(); i++) {
+			CHECK(Order[i] == i);
+		}
+
+		//Back to the ring once the spill is drained
+		Events.Push({ 0, 10 });
+		Order.clear();
+		CHECK(Events.Drain([&Order](const Event& Value) { Order.push_back(Value.Sequence); }) == 1);
+		CHECK(Order.size() == 1 && Order[0] == 10);
+	}
+}
+
+int main()
+{
+	TestSpillOrder();
+	TestRing();
+	TestSpilling();
+	return Check::Finish("EventQueueTests");
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "ControllerHull.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+//General convex hulls to check ControllerHull against, planes use the same convention (outward normal, w = -dot(normal, point)).
+//Neither cares about speed except QuickHull, which stands in for the general builder in the benchmark
+namespace ReferenceHull
+{
+	using ControllerHull::Vector;
+	using namespace ControllerHull::Detail;
+
+	inline bool SamePlane(const Vector& A, const Vector& B, float Tolerance)
+	{
+		return std::fabs(A.X - B.X) <= Tolerance && std::fabs(A.Y - B.Y) <= Tolerance && std::fabs(A.Z - B.Z) <= Tolerance && std::fabs(A.W - B.W) <= Tolerance;
+	}
+
+	//Coplanar faces (a quad split in two triangles) collapse into one plane
+	inline void AddUnique(std::vector<Vector>& Planes, const Vector& Plane, float Tolerance)
+	{
+		for (const Vector& Existing : Planes) {
+			if (SamePlane(Existing, Plane, Tolerance)) return;
+		}
+		Planes.push_back(Plane);
+	}
+
+	//Every plane through three of the points that has all the others on or behind it
+	inline std::vector<Vector> BruteForce(const Vector* Points, size_t Count, float Tolerance = 1e-4f)
+	{
+		std::vector<Vector> Planes;
+		for (size_t i = 0; i < Count; i++) {
+			for (size_t j = i + 1; j < Count; j++) {
+				for (size_t k = j + 1; k < Count; k++) {
+					Vector N = Cross(Sub(Points[j], Points[i]), Sub(Points[k], Points[i]));
+					const float Length = std::sqrt(Dot3(N, N));
+					if (!(Length > 1e-6f)) continue;
+
+					N = { N.X / Length, N.Y / Length, N.Z / Length, 0.f };
+					const float W = -Dot3(N, Points[i]);
+
+					bool Behind = true;
+					bool Front = true;
+					for (size_t p = 0; p < Count; p++) {
+						const float Distance = Dot3(N, Points[p]) + W;
+						Behind = Behind && Distance <= Tolerance;
+						Front = Front && Distance >= -Tolerance;
+					}
+
+					if (Behind) AddUnique(Planes, { N.X, N.Y, N.Z, W }, Tolerance * 10.f);
+					if (Front) AddUnique(Planes, { -N.X, -N.Y, -N.Z, -W }, Tolerance * 10.f);
+				}
+			}
+		}
+		return Planes;
+	}
+
+	//Textbook quickhull: start from a tetrahedron, then keep adding the furthest point outside any face, replacing the faces it
+	//sees with a fan from the point to their horizon. Allocates like a general builder does. False for flat or degenerate input
+	inline bool QuickHull(const Vector* Points, size_t Count, std::vector<Vector>& OutPlanes, float Tolerance = 1e-5f)
+	{
+		struct Face
+		{
+			int A, B, C;
+			Vector Plane;
+			std::vector<int> Outside;
+			bool Alive;
+		};
+
+		OutPlanes.clear();
+		if (Count < 4) return false;
+
+		const auto Distance = [](const Vector& Plane, const Vector& Point) { return Dot3(Plane, Point) + Plane.W; };
+
+		//Tetrahedron from the points furthest apart
+		int I0 = 0, I1 = 0;
+		float Best = -1.f;
+		for (size_t i = 0; i < Count; i++) {
+			for (size_t j = i + 1; j < Count; j++) {
+				const Vector D = Sub(Points[j], Points[i]);
+				if (Dot3(D, D) > Best) Best = Dot3(D, D), I0 = static_cast<int>(i), I1 = static_cast<int>(j);
+			}
+		}
+
+		int I2 = -1;
+		Best = 0.f;
+		const Vector Line = Sub(Points[I1], Points[I0]);
+		for (size_t i = 0; i < Count; i++) {
+			const Vector C = Cross(Line, Sub(Points[i], Points[I0]));
+			if (Dot3(C, C) > Best) Best = Dot3(C, C), I2 = static_cast<int>(i);
+		}
+		if (I2 < 0) return false;
+
+		int I3 = -1;
+		Best = 0.f;
+		const Vector Base = Cross(Line, Sub(Points[I2], Points[I0]));
+		for (size_t i = 0; i < Count; i++) {
+			const float D = std::fabs(Dot3(Base, Sub(Points[i], Points[I0])));
+			if (D > Best) Best = D, I3 = static_cast<int>(i);
+		}
+		if (I3 < 0 || Best <= Tolerance) return false;
+
+		const Vector Inside{ (Points[I0].X + Points[I1].X + Points[I2].X + Points[I3].X) * 0.25f, (Points[I0].Y + Points[I1].Y + Points[I2].Y + Points[I3].Y) * 0.25f,
+			(Points[I0].Z + Points[I1].Z + Points[I2].Z + Points[I3].Z) * 0.25f, 0.f };
+
+		std::vector<Face> Faces;
+
+		//Wound so the normal points away from Inside, that keeps every face's edges going the same way around the hull
+		const auto AddFace = [&](int A, int B, int C) {
+			Vector N = Cross(Sub(Points[B], Points[A]), Sub(Points[C], Points[A]));
+			if (Dot3(N, Sub(Inside, Points[A])) > 0.f) {
+				std::swap(B, C);
+				N = { -N.X, -N.Y, -N.Z, 0.f };
+			}
+			const float Length = std::sqrt(Dot3(N, N));
+			N = { N.X / Length, N.Y / Length, N.Z / Length, 0.f };
+			Faces.push_back({ A, B, C, { N.X, N.Y, N.Z, -Dot3(N, Points[A]) }, {}, true });
+		};
+
+		AddFace(I0, I1, I2);
+		AddFace(I0, I1, I3);
+		AddFace(I0, I2, I3);
+		AddFace(I1, I2, I3);
+
+		const auto Assign = [&](int Point, size_t FirstFace) {
+			for (size_t f = FirstFace; f < Faces.size(); f++) {
+				if (Faces[f].Alive && Distance(Faces[f].Plane, Points[Point]) > Tolerance) {
+					Faces[f].Outside.push_back(Point);
+					return;
+				}
+			}
+		};
+
+		for (size_t i = 0; i < Count; i++) {
+			const int Point = static_cast<int>(i);
+			if (Point != I0 && Point != I1 && Point != I2 && Point != I3) Assign(Point, 0);
+		}
+
+		std::vector<std::pair<int, int>> Horizon;
+		std::vector<int> Orphans;
+		for (size_t f = 0; f < Faces.size(); f++) {
+			if (!Faces[f].Alive || Faces[f].Outside.empty()) continue;
+
+			int Eye = Faces[f].Outside[0];
+			for (int Point : Faces[f].Outside) {
+				if (Distance(Faces[f].Plane, Points[Point]) > Distance(Faces[f].Plane, Points[Eye])) Eye = Point;
+			}
+
+			//Edges of the faces the eye sees that no other seen face shares make up the horizon
+			Horizon.clear();
+			Orphans.clear();
+			for (Face& Seen : Faces) {
+				if (!Seen.Alive || Distance(Seen.Plane, Points[Eye]) <= Tolerance) continue;
+				Seen.Alive = false;
+				for (int Point : Seen.Outside) {
+					if (Point != Eye) Orphans.push_back(Point);
+				}
+
+				const std::pair<int, int> Edges[3]{ { Seen.A, Seen.B }, { Seen.B, Seen.C }, { Seen.C, Seen.A } };
+				for (const auto& Edge : Edges) {
+					const auto Twin = std::find(Horizon.begin(), Horizon.end(), std::pair<int, int>{ Edge.second, Edge.first });
+					if (Twin != Horizon.end()) {
+						Horizon.erase(Twin);
+					} else {
+						Horizon.push_back(Edge);
+					}
+				}
+			}
+
+			const size_t FirstNew = Faces.size();
+			for (const auto& Edge : Horizon) {
+				AddFace(Edge.first, Edge.second, Eye);
+			}
+			for (int Point : Orphans) {
+				Assign(Point, FirstNew);
+			}
+		}
+
+		for (const Face& Hull : Faces) {
+			if (Hull.Alive) AddUnique(OutPlanes, Hull.Plane, 1e-4f);
+		}
+		return true;
+	}
+}
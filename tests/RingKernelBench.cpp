@@ -0,0 +1,82 @@
+#include "Bench.h"
+#include "Check.h"
+#include "ControllerHull.h"
+#include "RingKernel.h"
+#include "SyntheticHull.h"
+
+#include <vector>
+
+//Both rings of a Standard18 hull rescaled per iteration, every path the machine supports.
+//The baseline is the old per vertex loop, normalizing through a NiPoint3 style copy and divide
+namespace
+{
+	void OldLoop(float (*Verts)[4], const uint8_t* Indices, size_t Count, const RingKernel::Params& Ring)
+	{
+		for (size_t i = 0; i < Count; i++) {
+			float* V = Verts[Indices[i]];
+			float Z = V[2] * Ring.ZScale + Ring.ZOffset;
+			if (Ring.ClampToFloor && Z <= Ring.FloorZ) Z = Ring.FloorZ + Ring.FloorEpsilon;
+
+			float X = V[0];
+			float Y = V[1];
+			const float Length = std::sqrt(X * X + Y * Y + 0.f * 0.f);
+			if (Length > FLT_EPSILON) {
+				X /= Length;
+				Y /= Length;
+			} else {
+				X = Y = 0.f;
+			}
+
+			V[0] = X * Ring.Radius;
+			V[1] = Y * Ring.Radius;
+			V[2] = Z;
+			V[3] = 0.f;
+		}
+	}
+}
+
+int main(int ArgCount, char** Args)
+{
+	const bool Quick = Bench::IsQuick(ArgCount, Args);
+	const ControllerHull::Topology& Layout = ControllerHull::Standard18;
+
+	const std::vector<ControllerHull::Vector> Original = SyntheticHull::Make(Layout);
+	std::vector<ControllerHull::Vector> Verts = Original;
+	float (*Raw)[4] = reinterpret_cast<float (*)[4]>(Verts.data());
+
+	RingKernel::Params Ring{};
+	Ring.Radius = 0.3f;
+	Ring.ZScale = 1.01f;
+	Ring.ClampToFloor = true;
+	Ring.FloorZ = 0.1f;
+	Ring.FloorEpsilon = 0.0001f;
+
+	const size_t Iterations = Quick ? 64 : 5000000;
+
+	//Resetting the vertices every iteration keeps the values from drifting into denormals
+	const auto Run = [&](auto&& Apply) {
+		return Bench::Measure(Iterations, [&](size_t) {
+			Verts = Original;
+			Apply(Raw, Layout.TopRing.data(), Layout.RingSize, Ring);
+			Apply(Raw, Layout.BottomRing.data(), Layout.RingSize, Ring);
+			Bench::Consume(Raw[1][0]);
+		});
+	};
+
+	const double Old = Run(OldLoop);
+	std::printf("Old loop %6.1fns\n", Old);
+
+	const RingKernel::Level Supported = RingKernel::SupportedLevel();
+	const char* Names[]{ "Scalar", "SSE4.1", "AVX2" };
+	for (RingKernel::Level Path : { RingKernel::Level::kScalar, RingKernel::Level::kSSE41, RingKernel::Level::kAVX2 }) {
+		if (Path > Supported) continue;
+
+		const double Time = Run([Path](float (*V)[4], const uint8_t* Indices, size_t Count, const RingKernel::Params& Params) {
+			RingKernel::Apply(V, Indices, Count, Params, Path);
+		});
+		std::printf("%-8s %6.1fns (%.1fx)\n", Names[static_cast<int>(Path)], Time, Old / Time);
+	}
+
+	CHECK(Supported >= RingKernel::Level::kScalar);
+	return Check::Finish("RingKernelBench");
+}
@@ -0,0 +1,200 @@
+#include "Check.h"
+#include "RingKernel.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+//The kernel against the loop it replaced, and every vector path against the scalar one, over random rings
+namespace
+{
+	constexpr size_t Rings = 100000;
+
+	//NiPoint3 as the original loop used it
+	struct OldPoint3
+	{
+		float x, y, z;
+
+		float Length() const { return std::sqrt(x * x + y * y + z * z); }
+
+		void Unitize()
+		{
+			const float Length = this->Length();
+			if (Length == 1.f) return;
+			if (Length > FLT_EPSILON) {
+				x /= Length;
+				y /= Length;
+				z /= Length;
+			} else {
+				x = y = z = 0.f;
+			}
+		}
+	};
+
+	//The z pass and the radial pass were two loops in the original, the radial one went through NiPoint3
+	void OldLoop(float (*Verts)[4], const uint8_t* Indices, size_t Count, const RingKernel::Params& Ring)
+	{
+		for (size_t i = 0; i < Count; i++) {
+			float* V = Verts[Indices[i]];
+			const float Z = V[2] * Ring.ZScale + Ring.ZOffset;
+			V[2] = (Ring.ClampToFloor && Z <= Ring.FloorZ) ? Ring.FloorZ + Ring.FloorEpsilon : Z;
+		}
+
+		for (size_t i = 0; i < Count; i++) {
+			float* V = Verts[Indices[i]];
+			const OldPoint3 Vert{ V[0], V[1], V[2] };
+			OldPoint3 NewVert = Vert;
+			NewVert.z = 0;
+			NewVert.Unitize();
+			NewVert.x *= Ring.Radius;
+			NewVert.y *= Ring.Radius;
+			NewVert.z = Vert.z;
+
+			V[0] = NewVert.x;
+			V[1] = NewVert.y;
+			V[2] = NewVert.z;
+			V[3] = 0.f;
+		}
+	}
+
+	//Floats as integers that count up through every representable value, so the difference is the distance in ulps
+	int64_t Ordered(float Value)
+	{
+		int32_t Bits;
+		std::memcpy(&Bits, &Value, sizeof(Bits));
+		return Bits < 0 ? -static_cast<int64_t>(Bits & 0x7fffffff) : Bits;
+	}
+
+	uint32_t UlpDistance(float A, float B)
+	{
+		if (A == B) return 0;  //Also +0 and -0
+		return static_cast<uint32_t>(std::min<int64_t>(std::llabs(Ordered(A) - Ordered(B)), UINT32_MAX));
+	}
+
+	struct Case
+	{
+		std::vector<float> Verts;  //xyzw
+		std::vector<uint8_t> Indices;
+		RingKernel::Params Ring;
+	};
+
+	//Rings scattered through a larger vertex array like the hull's, with the odd zero length and unit length vertex
+	Case MakeCase(std::mt19937& Random, size_t RingSize)
+	{
+		std::uniform_real_distribution<float> Coordinate(-3.f, 3.f);
+		std::uniform_real_distribution<float> Positive(0.05f, 4.f);
+		std::uniform_int_distribution<int> Special(0, 31);
+
+		Case Out{};
+		const size_t VertexCount = RingSize * 2 + 2;
+		Out.Verts.resize(VertexCount * 4);
+		for (size_t i = 0; i < VertexCount; i++) {
+			float* V = &Out.Verts[i * 4];
+			V[0] = Coordinate(Random);
+			V[1] = Coordinate(Random);
+			V[2] = Coordinate(Random);
+			V[3] = 1.f;
+
+			const int Kind = Special(Random);
+			if (Kind == 0) {
+				V[0] = 0.f, V[1] = 0.f;
+			} else if (Kind == 1) {
+				V[0] = 1e-9f, V[1] = -1e-9f;
+			} else if (Kind == 2) {
+				V[0] = 0.6f, V[1] = 0.8f;
+			}
+		}
+
+		for (size_t i = 0; i < RingSize; i++) {
+			Out.Indices.push_back(static_cast<uint8_t>((i * 7 + 3) % VertexCount));
+		}
+
+		Out.Ring.ZScale = Positive(Random);
+		Out.Ring.ZOffset = Coordinate(Random);
+		Out.Ring.ClampToFloor = Special(Random) < 16;
+		Out.Ring.FloorZ = Coordinate(Random);
+		Out.Ring.FloorEpsilon = 0.0001f;
+		Out.Ring.Radius = Positive(Random);
+		return Out;
+	}
+
+	float (*AsVerts(std::vector<float>& Verts))[4]
+	{
+		return reinterpret_cast<float (*)[4]>(Verts.data());
+	}
+
+	void TestAgainstOldLoop()
+	{
+		std::mt19937 Random(1234);
+		uint64_t Coordinates = 0;
+		uint64_t Exact = 0;
+		uint32_t WorstUlps = 0;
+		bool ZMatches = true;
+		bool WCleared = true;
+
+		for (size_t r = 0; r < Rings; r++) {
+			Case Input = MakeCase(Random, 8);
+			std::vector<float> Old = Input.Verts;
+			std::vector<float> New = Input.Verts;
+
+			OldLoop(AsVerts(Old), Input.Indices.data(), Input.Indices.size(), Input.Ring);
+			RingKernel::ApplyScalar(AsVerts(New), Input.Indices.data(), Input.Indices.size(), Input.Ring);
+
+			for (uint8_t Index : Input.Indices) {
+				for (int Axis = 0; Axis < 2; Axis++) {
+					const uint32_t Ulps = UlpDistance(Old[Index * 4 + Axis], New[Index * 4 + Axis]);
+					WorstUlps = std::max(WorstUlps, Ulps);
+					Exact += Ulps == 0;
+					Coordinates++;
+				}
+				ZMatches = ZMatches && Old[Index * 4 + 2] == New[Index * 4 + 2];
+				WCleared = WCleared && New[Index * 4 + 3] == 0.f;
+			}
+		}
+
+		CHECK(WorstUlps == 0);
+		CHECK(ZMatches);
+		CHECK(WCleared);
+		std::printf("Scalar against the old loop: %llu of %llu xy coordinates identical, worst %u ulp\n", static_cast<unsigned long long>(Exact), static_cast<unsigned long long>(Coordinates), WorstUlps);
+	}
+
+	//Ring sizes that are not a multiple of the vector width go through the tails
+	void TestVectorPaths()
+	{
+		const RingKernel::Level Supported = RingKernel::SupportedLevel();
+		std::mt19937 Random(5678);
+
+		for (RingKernel::Level Path : { RingKernel::Level::kSSE41, RingKernel::Level::kAVX2 }) {
+			if (Path > Supported) {
+				std::printf("Level %d not supported here, skipped\n", static_cast<int>(Path));
+				continue;
+			}
+
+			uint64_t Mismatches = 0;
+			for (size_t RingSize : { 3, 4, 5, 7, 8, 9, 12, 16 }) {
+				for (size_t r = 0; r < Rings / 8; r++) {
+					Case Input = MakeCase(Random, RingSize);
+					std::vector<float> Scalar = Input.Verts;
+					std::vector<float> Vector = Input.Verts;
+
+					RingKernel::ApplyScalar(AsVerts(Scalar), Input.Indices.data(), Input.Indices.size(), Input.Ring);
+					RingKernel::Apply(AsVerts(Vector), Input.Indices.data(), Input.Indices.size(), Input.Ring, Path);
+					Mismatches += std::memcmp(Scalar.data(), Vector.data(), Scalar.size() * sizeof(float)) != 0;
+				}
+			}
+
+			CHECK(Mismatches == 0);
+			std::printf("Level %d against scalar: %llu mismatching rings\n", static_cast<int>(Path), static_cast<unsigned long long>(Mismatches));
+		}
+	}
+}
+
+int main()
+{
+	TestAgainstOldLoop();
+	TestVectorPaths();
+	return Check::Finish("RingKernelTests");
+}
@@ -0,0 +1,205 @@
+#include "Check.h"
+#include "Scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+
+//The order jobs are handed out in, what the budget and the job limit cut off, and what is left over for the next frame
+namespace
+{
+	using Scheduler = FrameScheduler<uint32_t>;
+	using Tier = Scheduler::Tier;
+
+	constexpr float Unlimited = std::numeric_limits<float>::infinity();
+	constexpr uint32_t PlayerId = 1000;
+
+	//Runs the jobs and returns their ids in the order they ran, Work is called once per batch.
+	//Every batch but the last is full, the last one holds whatever was left
+	template <class Func>
+	std::vector<uint32_t> RunJobs(Scheduler& Queue, float BudgetMicroseconds, size_t MaxJobs, size_t BatchSize, Func&& Work)
+	{
+		std::vector<uint32_t> Ran;
+		std::vector<size_t> Batches;
+		const size_t Processed = Queue.Run(BudgetMicroseconds, MaxJobs, BatchSize, [&](const Scheduler::Job* Jobs, size_t Count) {
+			for (size_t i = 0; i < Count; i++) {
+				Ran.push_back(Jobs[i].Id);
+			}
+			Batches.push_back(Count);
+			Work();
+		});
+		CHECK(Processed == Ran.size());
+
+		for (size_t i = 0; i < Batches.size(); i++) {
+			CHECK(Batches[i] > 0);
+			CHECK(Batches[i] <= std::max<size_t>(BatchSize, 1));
+			if (i + 1 < Batches.size()) CHECK(Batches[i] == std::max<size_t>(BatchSize, 1));
+		}
+		return Ran;
+	}
+
+	std::vector<uint32_t> RunJobs(Scheduler& Queue, float BudgetMicroseconds, size_t MaxJobs, size_t BatchSize = 1)
+	{
+		return RunJobs(Queue, BudgetMicroseconds, MaxJobs, BatchSize, []() {});
+	}
+
+	//The player outranks everything, even npc's that are right next to the camera and have waited for ages
+	void TestPlayerFirst()
+	{
+		std::mt19937 Random(3);
+		for (int Round = 0; Round < 200; Round++) {
+			Scheduler Queue;
+			const uint32_t Count = std::uniform_int_distribution<uint32_t>(1, 40)(Random);
+			const uint32_t PlayerAt = std::uniform_int_distribution<uint32_t>(0, Count)(Random);
+			for (uint32_t i = 0; i <= Count; i++) {
+				if (i == PlayerAt) {
+					Queue.Push(PlayerId, Tier::kPlayer, 100000.f, 0);
+				} else {
+					const Tier JobTier = std::uniform_int_distribution<int>(0, 1)(Random) ? Tier::kFollower : Tier::kNPC;
+					Queue.Push(i, JobTier, std::uniform_real_distribution<float>(0.f, 8192.f)(Random), std::uniform_int_distribution<uint32_t>(0, 1000)(Random));
+				}
+			}
+
+			const std::vector<uint32_t> All = RunJobs(Queue, Unlimited, SIZE_MAX, std::uniform_int_distribution<size_t>(1, 8)(Random));
+			CHECK(All.size() == Count + 1u);
+			CHECK(!All.empty() && All[0] == PlayerId);
+
+			//Also when only one job fits
+			const std::vector<uint32_t> One = RunJobs(Queue, Unlimited, 1);
+			CHECK(One.size() == 1 && One[0] == PlayerId);
+		}
+	}
+
+	//Among the rest tier counts as TierDistance and every frame of waiting takes AgingDistance off. An npc that waited long
+	//enough overtakes a fresh follower at the same distance, and a nearer job beats a farther one of the same tier and age
+	void TestAging()
+	{
+		const uint32_t Overtakes = static_cast<uint32_t>(Scheduler::TierDistance / Scheduler::AgingDistance) + 1;
+
+		Scheduler Queue;
+		Queue.Push(1, Tier::kFollower, 300.f, 0);
+		Queue.Push(2, Tier::kNPC, 300.f, Overtakes - 2);
+		std::vector<uint32_t> Ran = RunJobs(Queue, Unlimited, SIZE_MAX);
+		CHECK(Ran == std::vector<uint32_t>({ 1, 2 }));
+
+		Queue.Clear();
+		Queue.Push(1, Tier::kFollower, 300.f, 0);
+		Queue.Push(2, Tier::kNPC, 300.f, Overtakes);
+		Ran = RunJobs(Queue, Unlimited, SIZE_MAX);
+		CHECK(Ran == std::vector<uint32_t>({ 2, 1 }));
+
+		//A deferred npc pushed again with one more frame of age each time gets ahead of followers pushed fresh every frame
+		uint32_t Age = 0;
+		bool Overtook = false;
+		for (uint32_t Frame = 0; Frame < 64 && !Overtook; Frame++) {
+			Queue.Clear();
+			Queue.Push(1, Tier::kFollower, 1000.f, 0);
+			Queue.Push(2, Tier::kFollower, 1500.f, 0);
+			Queue.Push(3, Tier::kNPC, 2000.f, Age);
+			Ran = RunJobs(Queue, Unlimited, 1);
+			Overtook = Ran == std::vector<uint32_t>({ 3 });
+			Age++;
+		}
+		CHECK(Overtook);
+
+		Queue.Clear();
+		Queue.Push(1, Tier::kNPC, 900.f, 2);
+		Queue.Push(2, Tier::kNPC, 100.f, 2);
+		Queue.Push(3, Tier::kNPC, 500.f, 2);
+		Ran = RunJobs(Queue, Unlimited, SIZE_MAX);
+		CHECK(Ran == std::vector<uint32_t>({ 2, 3, 1 }));
+	}
+
+	//A budget that is already spent still lets the first batch through, so a tiny budget can never stall everything.
+	//The player is always in it
+	void TestFirstAlwaysRuns()
+	{
+		Scheduler Queue;
+		for (uint32_t i = 0; i < 10; i++) {
+			Queue.Push(i, Tier::kNPC, static_cast<float>(i), 0);
+		}
+
+		std::vector<uint32_t> Ran = RunJobs(Queue, 0.f, SIZE_MAX);
+		CHECK(Ran == std::vector<uint32_t>({ 0 }));
+
+		Ran = RunJobs(Queue, 0.f, SIZE_MAX, 4);
+		CHECK(Ran == std::vector<uint32_t>({ 0, 1, 2, 3 }));
+
+		//Every batch takes longer than the whole budget, only the first gets in
+		Ran = RunJobs(Queue, 1000.f, SIZE_MAX, 3, []() { std::this_thread::sleep_for(std::chrono::milliseconds(2)); });
+		CHECK(Ran == std::vector<uint32_t>({ 0, 1, 2 }));
+
+		//Far behind, but still in the first batch
+		Queue.Push(PlayerId, Tier::kPlayer, 100000.f, 0);
+		Ran = RunJobs(Queue, 0.f, SIZE_MAX, 2);
+		CHECK(Ran == std::vector<uint32_t>({ PlayerId, 0 }));
+
+		//A job limit of 0 counts as 1, and so does a batch size of 0
+		Ran = RunJobs(Queue, Unlimited, 0, 4);
+		CHECK(Ran.size() == 1);
+		Ran = RunJobs(Queue, Unlimited, SIZE_MAX, 0);
+		CHECK(Ran.size() == 11);
+
+		Scheduler Empty;
+		CHECK(RunJobs(Empty, 0.f, SIZE_MAX).empty());
+	}
+
+	//ForEachDeferred hands back exactly the pushed jobs that did not run, whether the limit or the budget cut them off
+	void TestDeferred()
+	{
+		std::mt19937 Random(11);
+		for (int Round = 0; Round < 300; Round++) {
+			Scheduler Queue;
+			const uint32_t Count = std::uniform_int_distribution<uint32_t>(0, 50)(Random);
+			for (uint32_t i = 0; i < Count; i++) {
+				const Tier JobTier = i == 0 && Round % 2 ? Tier::kPlayer : (i % 3 ? Tier::kNPC : Tier::kFollower);
+				Queue.Push(i, JobTier, std::uniform_real_distribution<float>(0.f, 8192.f)(Random), std::uniform_int_distribution<uint32_t>(0, 20)(Random));
+			}
+
+			const size_t MaxJobs = std::uniform_int_distribution<size_t>(0, 60)(Random);
+			const size_t BatchSize = std::uniform_int_distribution<size_t>(1, 12)(Random);
+			const bool Budgeted = Round % 3 == 0;
+			std::vector<uint32_t> Ran = RunJobs(Queue, Budgeted ? 0.f : Unlimited, MaxJobs, BatchSize);
+
+			std::vector<uint32_t> Deferred;
+			Queue.ForEachDeferred([&](const Scheduler::Job& Job) { Deferred.push_back(Job.Id); });
+
+			const size_t Considered = std::min<size_t>(Count, std::max<size_t>(MaxJobs, 1));
+			const size_t Expected = Budgeted ? std::min(Considered, BatchSize) : Considered;
+			CHECK(Ran.size() == Expected);
+			CHECK(Ran.size() + Deferred.size() == Count);
+			CHECK(Queue.Size() == Count);
+
+			std::vector<uint32_t> Both = Ran;
+			Both.insert(Both.end(), Deferred.begin(), Deferred.end());
+			std::sort(Both.begin(), Both.end());
+			bool Complete = Both.size() == Count;
+			for (uint32_t i = 0; Complete && i < Count; i++) {
+				Complete = Both[i] == i;
+			}
+			CHECK(Complete);
+		}
+
+		//Clear forgets the last run's leftovers
+		Scheduler Queue;
+		Queue.Push(1, Tier::kNPC, 0.f, 0);
+		Queue.Push(2, Tier::kNPC, 1.f, 0);
+		RunJobs(Queue, Unlimited, 1);
+		Queue.Clear();
+		size_t Left = 0;
+		Queue.ForEachDeferred([&](const Scheduler::Job&) { Left++; });
+		CHECK(Left == 0);
+	}
+}
+
+int main()
+{
+	TestPlayerFirst();
+	TestAging();
+	TestFirstAlwaysRuns();
+	TestDeferred();
+	return Check::Finish("SchedulerTests");
+}
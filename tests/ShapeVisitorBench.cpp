@@ -0,0 +1,54 @@
+#include "Bench.h"
+#include "Check.h"
+#include "ShapeVisitor.h"
+#include "SyntheticShapes.h"
+
+#include <vector>
+
+//GetShapes on a mock controller before and after the visitor: the old recursive walk into a fresh std::vector with a
+//buffer on the stack per container, against the visitor's inline result and reused per level buffers
+int main(int ArgCount, char** Args)
+{
+	using SyntheticShapes::Shape;
+	using Traits = SyntheticShapes::Traits;
+
+	const bool Quick = Bench::IsQuick(ArgCount, Args);
+	const size_t Iterations = Quick ? 64 : 2000000;
+
+	SyntheticShapes::Tree Shapes;
+	const Shape* Trees[]{ SyntheticShapes::MakeController(Shapes), SyntheticShapes::MakeCreature(Shapes) };
+	const char* Names[]{ "controller", "creature" };
+
+	ShapeVisitor::Walker<Traits> Walker;
+	for (size_t t = 0; t < 2; t++) {
+		const Shape* Root = Trees[t];
+
+		const double Old = Bench::Measure(Iterations, [&](size_t) {
+			std::vector<Shape*> Capsules{};
+			Shape* Convex = nullptr;
+			SyntheticShapes::Reference(Root, Capsules, Convex);
+			Bench::Consume(Capsules.size());
+			Bench::Consume(Convex);
+		});
+
+		const double Visitor = Bench::Measure(Iterations, [&](size_t) {
+			ShapeVisitor::Result<Traits, ShapeVisitor::kCapsules | ShapeVisitor::kConvexShape> Found{};
+			Walker.Visit(Root, Found);
+			Bench::Consume(Found.Capsules.size());
+			Bench::Consume(Found.ConvexShape);
+		});
+
+		//Both walks have to find the same shapes for the comparison to mean anything
+		std::vector<Shape*> Capsules;
+		Shape* Convex = nullptr;
+		SyntheticShapes::Reference(Root, Capsules, Convex);
+		ShapeVisitor::Result<Traits, ShapeVisitor::kCapsules | ShapeVisitor::kConvexShape> Found{};
+		Walker.Visit(Root, Found);
+		CHECK(Found.Capsules.size() == Capsules.size() && Found.ConvexShape == Convex);
+
+		std::printf("%-10s old walk %6.1fns, visitor %6.1fns (%.1fx)\n", Names[t], Old, Visitor, Old / Visitor);
+	}
+
+	CHECK(SyntheticShapes::Clobbered == 0);
+	return Check::Finish("ShapeVisitorBench");
+}
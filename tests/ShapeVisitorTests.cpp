@@ -0,0 +1,220 @@
+#include "Check.h"
+#include "ShapeVisitor.h"
+#include "SyntheticShapes.h"
+
+#include <random>
+#include <utility>
+#include <vector>
+
+//The visitor against the recursive walk it replaced, on hand built and random mock shape trees
+namespace
+{
+	using ShapeVisitor::Kind;
+	using SyntheticShapes::Shape;
+	using Traits = SyntheticShapes::Traits;
+
+	template <uint8_t What, size_t MaxCapsules = 16>
+	using Found = ShapeVisitor::Result<Traits, What, MaxCapsules>;
+
+	constexpr uint8_t Everything = ShapeVisitor::kCapsules | ShapeVisitor::kConvexShape;
+
+	template <uint8_t What, size_t MaxCapsules>
+	bool SameCapsules(const Found<What, MaxCapsules>& Result, const std::vector<Shape*>& Expected)
+	{
+		if (Result.Capsules.size() != Expected.size()) return false;
+		for (size_t i = 0; i < Expected.size(); i++) {
+			if (Result.Capsules[i] != Expected[i]) return false;
+		}
+		return true;
+	}
+
+	//Capsules in walk order, the first convex shape only, and only what was asked for
+	void TestCollect()
+	{
+		SyntheticShapes::Tree Shapes;
+		const Shape* Capsules[6]{ Shapes.Capsule(), Shapes.Capsule(), Shapes.Capsule(), Shapes.Capsule(), Shapes.Capsule(), Shapes.Capsule() };
+		const Shape* FirstConvex = Shapes.Convex();
+		const Shape* LaterConvex = Shapes.Convex();
+		const Shape* Root = Shapes.List({ Capsules[0], FirstConvex,
+			Shapes.List({ Capsules[1], Shapes.Container({ Capsules[2], Shapes.List({ Capsules[3], LaterConvex }), Shapes.Container({ Capsules[4] }) }) }),
+			nullptr, Capsules[5], Shapes.Add(Kind::kOther, { Shapes.Capsule() }) });
+
+		std::vector<Shape*> Expected;
+		for (const Shape* Capsule : Capsules) {
+			Expected.push_back(const_cast<Shape*>(Capsule));
+		}
+
+		ShapeVisitor::Walker<Traits> Walker;
+
+		Found<Everything> Both{};
+		Walker.Visit(Root, Both);
+		CHECK(SameCapsules(Both, Expected));
+		CHECK(Both.ConvexShape == FirstConvex);
+
+		Found<ShapeVisitor::kCapsules> CapsulesOnly{};
+		Walker.Visit(Root, CapsulesOnly);
+		CHECK(SameCapsules(CapsulesOnly, Expected));
+		CHECK(CapsulesOnly.ConvexShape == nullptr);
+
+		Found<ShapeVisitor::kConvexShape> ConvexOnly{};
+		Walker.Visit(Root, ConvexOnly);
+		CHECK(ConvexOnly.Capsules.empty());
+		CHECK(ConvexOnly.ConvexShape == FirstConvex);
+
+		//Results add up over walks until cleared, like the callers' lists did
+		Walker.Visit(Root, Both);
+		CHECK(Both.Capsules.size() == 12 && Both.ConvexShape == FirstConvex);
+		Both.clear();
+		CHECK(Both.Capsules.empty() && Both.ConvexShape == nullptr);
+
+		Found<Everything> None{};
+		Walker.Visit(nullptr, None);
+		CHECK(None.Capsules.empty() && None.ConvexShape == nullptr);
+	}
+
+	//Past MaxCapsules the rest is dropped and counted, the kept ones are the first in walk order
+	void TestCapacity()
+	{
+		SyntheticShapes::Tree Shapes;
+		const Shape* Capsules[6]{ Shapes.Capsule(), Shapes.Capsule(), Shapes.Capsule(), Shapes.Capsule(), Shapes.Capsule(), Shapes.Capsule() };
+		const Shape* Root = Shapes.List({ Capsules[0], Capsules[1], Shapes.Container({ Capsules[2], Capsules[3], Capsules[4] }), Capsules[5] });
+
+		ShapeVisitor::Walker<Traits> Walker;
+		Found<ShapeVisitor::kCapsules, 4> Result{};
+		Walker.Visit(Root, Result);
+		CHECK(Result.Capsules.size() == 4);
+		CHECK(Result.Capsules.dropped() == 2);
+		for (size_t i = 0; i < 4; i++) {
+			CHECK(Result.Capsules[i] == Capsules[i]);
+		}
+
+		Result.clear();
+		CHECK(Result.Capsules.size() == 0 && Result.Capsules.dropped() == 0);
+	}
+
+	//The walker's buffers are private, this sees them as they are handed to the traits
+	struct Watching : Traits
+	{
+		static inline std::vector<std::pair<const ChildBuffer*, size_t>> Seen;
+
+		template <class Fn>
+		static void ForEachContainerChild(const Shape* Node, ChildBuffer& Buffer, Fn&& Callback)
+		{
+			Seen.push_back({ &Buffer, Node->Children.size() });
+			Traits::ForEachContainerChild(Node, Buffer, Callback);
+		}
+	};
+
+	//Every level of containers gets its own buffer, reused for all children on that level and from one walk to the next.
+	//A container below another one must not write into the buffer its parent's child is still in
+	void TestBuffers()
+	{
+		SyntheticShapes::Tree Shapes;
+		const Shape* Inner = Shapes.Container({ Shapes.Capsule(), Shapes.Container({ Shapes.Capsule(), Shapes.Capsule() }), Shapes.Capsule() });
+		const Shape* Root = Shapes.Container({ Inner, Shapes.Capsule(), Shapes.List({ Shapes.Container({ Shapes.Capsule() }) }) });
+
+		SyntheticShapes::Clobbered = 0;
+		ShapeVisitor::Walker<Watching> Walker;
+		ShapeVisitor::Result<Watching, ShapeVisitor::kCapsules> Result{};
+		Walker.Visit(Root, Result);
+		CHECK(Result.Capsules.size() == 6);
+		CHECK(SyntheticShapes::Clobbered == 0);
+
+		//Root at depth 0, Inner at 1, its container at 2, the one in the list at 2 as well
+		const auto First = Watching::Seen;
+		CHECK(First.size() == 4);
+		if (First.size() == 4) {
+			CHECK(First[0].first != First[1].first && First[1].first != First[2].first && First[0].first != First[2].first);
+			CHECK(First[3].first == First[2].first);
+			CHECK(First[0].first->Writes == 3);
+			CHECK(First[2].first->Writes == 3);
+		}
+
+		//Same buffers the next time round
+		Watching::Seen.clear();
+		Walker.Visit(Root, Result);
+		CHECK(Watching::Seen.size() == First.size());
+		for (size_t i = 0; i < First.size() && i < Watching::Seen.size(); i++) {
+			CHECK(Watching::Seen[i].first == First[i].first);
+		}
+		CHECK(SyntheticShapes::Clobbered == 0);
+	}
+
+	//Shapes at depth MaxDepth and below are skipped, containers at the last level still get a buffer
+	void TestMaxDepth()
+	{
+		SyntheticShapes::Tree Shapes;
+		const Shape* AtThree = Shapes.Capsule();
+		const Shape* AtFour = Shapes.Capsule();
+		const Shape* Root = Shapes.List({ Shapes.Container({ Shapes.List({ AtThree, Shapes.Container({ AtFour }) }) }) });
+
+		ShapeVisitor::Walker<Traits, 4> Shallow;
+		Found<ShapeVisitor::kCapsules> Cut{};
+		Shallow.Visit(Root, Cut);
+		CHECK(Cut.Capsules.size() == 1 && Cut.Capsules[0] == AtThree);
+
+		ShapeVisitor::Walker<Traits, 5> Deep;
+		Found<ShapeVisitor::kCapsules> Full{};
+		Deep.Visit(Root, Full);
+		CHECK(Full.Capsules.size() == 2 && Full.Capsules[1] == AtFour);
+
+		//A chain of containers longer than MaxDepth stops at the last buffer
+		const Shape* Chain = Shapes.Capsule();
+		for (int i = 0; i < 12; i++) {
+			Chain = Shapes.Container({ Chain });
+		}
+		ShapeVisitor::Walker<Traits> Default;
+		Found<ShapeVisitor::kCapsules> ChainResult{};
+		Default.Visit(Chain, ChainResult);
+		CHECK(ChainResult.Capsules.empty());
+	}
+
+	//Random trees of every kind, limited to MaxDepth and MaxCapsules so the reference sees the same tree
+	void TestRandom()
+	{
+		std::mt19937 Random(99);
+		ShapeVisitor::Walker<Traits> Walker;
+		SyntheticShapes::Clobbered = 0;
+
+		for (int t = 0; t < 2000; t++) {
+			SyntheticShapes::Tree Shapes;
+			const auto Make = [&](const auto& Self, size_t Depth) -> const Shape* {
+				const int Roll = std::uniform_int_distribution<int>(0, Depth >= 9 ? 2 : 5)(Random);
+				if (Roll == 0) return Shapes.Capsule();
+				if (Roll == 1) return Shapes.Convex();
+				if (Roll == 2) return Shapes.Add(Kind::kOther);
+
+				const int Count = std::uniform_int_distribution<int>(0, 3)(Random);
+				std::vector<const Shape*> Children;
+				for (int i = 0; i < Count; i++) {
+					Children.push_back(Self(Self, Depth + 1));
+				}
+				const Shape* Node = Shapes.Add(Roll == 3 ? Kind::kList : Kind::kContainer);
+				const_cast<Shape*>(Node)->Children = Children;
+				return Node;
+			};
+			const Shape* Root = Make(Make, 0);
+
+			std::vector<Shape*> Capsules;
+			Shape* Convex = nullptr;
+			SyntheticShapes::Reference(Root, Capsules, Convex, 8);
+			if (Capsules.size() > 64) continue;
+
+			Found<Everything, 64> Result{};
+			Walker.Visit(Root, Result);
+			CHECK(SameCapsules(Result, Capsules));
+			CHECK(Result.ConvexShape == Convex);
+		}
+		CHECK(SyntheticShapes::Clobbered == 0);
+	}
+}
+
+int main()
+{
+	TestCollect();
+	TestCapacity();
+	TestBuffers();
+	TestMaxDepth();
+	TestRandom();
+	return Check::Finish("ShapeVisitorTests");
+}
@@ -0,0 +1,68 @@
+#include "Bench.h"
+#include "Check.h"
+#include "SkeletonIndex.h"
+#include "SyntheticSkeleton.h"
+
+#include <string>
+#include <vector>
+
+//Bone lookups on 300 node skeletons: the breadth first search FindBoneNode used to fall back to, the early exit pre-order
+//Search it uses now, and BoneCache's Build once then Find per bone. Every lookup asks for a random bone of the skeleton
+int main(int ArgCount, char** Args)
+{
+	using SyntheticSkeleton::Node;
+	using Index = SkeletonIndex<Node, SyntheticSkeleton::Traits>;
+
+	const bool Quick = Bench::IsQuick(ArgCount, Args);
+
+	std::vector<SyntheticSkeleton::Skeleton> Skeletons;
+	for (uint32_t Seed = 1; Seed <= 8; Seed++) {
+		Skeletons.push_back(SyntheticSkeleton::Make(300, Seed));
+	}
+
+	//Names as separate strings like the callers pass them, not the nodes' own
+	std::vector<std::string> Names;
+	std::mt19937 Random(42);
+	std::uniform_int_distribution<size_t> Pick(0, 299);
+	for (int i = 0; i < 1024; i++) {
+		Names.push_back(Skeletons[0].Nodes[Pick(Random)].Name);
+	}
+
+	const size_t Iterations = Quick ? 64 : 200000;
+	const auto SkeletonFor = [&](size_t i) -> SyntheticSkeleton::Skeleton& { return Skeletons[(i / Names.size()) % Skeletons.size()]; };
+
+	size_t Found = 0;
+	const double BreadthFirst = Bench::Measure(Iterations, [&](size_t i) {
+		Node* Bone = SyntheticSkeleton::BreadthFirst(SkeletonFor(i).Root, Names[i % Names.size()]);
+		Found += Bone != nullptr;
+		Bench::Consume(Bone);
+	});
+
+	Index Bones;
+	const double Search = Bench::Measure(Iterations, [&](size_t i) {
+		Node* Bone = Bones.Search(SkeletonFor(i).Root, Names[i % Names.size()]);
+		Found += Bone != nullptr;
+		Bench::Consume(Bone);
+	});
+
+	const double Build = Bench::Measure(Quick ? 8 : 20000, [&](size_t i) {
+		Bones.Build(Skeletons[i % Skeletons.size()].Root);
+		Bench::Consume(Bones.Entries().size());
+	});
+
+	//Same skeleton for the whole run, that is how BoneCache uses it
+	Bones.Build(Skeletons[0].Root);
+	const double Find = Bench::Measure(Iterations, [&](size_t i) {
+		Node* Bone = Bones.Find(Names[i % Names.size()]);
+		Found += Bone != nullptr;
+		Bench::Consume(Bone);
+	});
+
+	//The names all exist in every skeleton, the walks ran 5 runs of Iterations each and Find as many
+	CHECK(Found == Iterations * 5 * 3);
+
+	std::printf("300 nodes: breadth first %.1fns, search %.1fns (%.1fx), build %.1fns, find %.1fns (%.1fx)\n", BreadthFirst, Search, BreadthFirst / Search, Build, Find,
+		BreadthFirst / Find);
+	std::printf("Build + Find pays off after %.1f lookups per skeleton\n", Build / (Search - Find));
+	return Check::Finish("SkeletonIndexBench");
+}
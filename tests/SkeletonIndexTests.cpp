@@ -0,0 +1,163 @@
+#include "Check.h"
+#include "SkeletonIndex.h"
+#include "SyntheticSkeleton.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+//Build, Find and Search against a plain recursive pre-order walk over synthetic skeletons
+namespace
+{
+	using SyntheticSkeleton::Node;
+	using Index = SkeletonIndex<Node, SyntheticSkeleton::Traits>;
+
+	void TestBuild()
+	{
+		for (uint32_t Seed = 1; Seed <= 8; Seed++) {
+			SyntheticSkeleton::Skeleton Skeleton = SyntheticSkeleton::Make(300, Seed);
+			std::vector<Node*> Order;
+			SyntheticSkeleton::PreOrder(Skeleton.Root, Order);
+
+			Index Bones;
+			Bones.Build(Skeleton.Root);
+			const auto& Entries = Bones.Entries();
+			CHECK(Entries.size() == 300);
+			CHECK(Entries[0].Parent == Index::NoParent);
+
+			for (size_t i = 0; i < Entries.size() && i < Order.size(); i++) {
+				CHECK(Entries[i].Node == Order[i]);
+				CHECK(Entries[i].Name == Order[i]->Name.c_str());
+				if (i == 0) continue;
+
+				//Parents come before their children and actually hold them
+				const int32_t Parent = Entries[i].Parent;
+				CHECK(Parent >= 0 && static_cast<size_t>(Parent) < i);
+				if (Parent < 0 || static_cast<size_t>(Parent) >= i) continue;
+				const auto& Siblings = Entries[Parent].Node->Children;
+				CHECK(std::find(Siblings.begin(), Siblings.end(), Entries[i].Node) != Siblings.end());
+			}
+
+			//Every name through the hash table, the early exit walk and the breadth first search it replaced
+			for (Node& Bone : Skeleton.Nodes) {
+				CHECK(Bones.Find(Bone.Name) == &Bone);
+				CHECK(Bones.Search(Skeleton.Root, Bone.Name) == &Bone);
+				CHECK(SyntheticSkeleton::BreadthFirst(Skeleton.Root, Bone.Name) == &Bone);
+			}
+
+			CHECK(Bones.Find("NPC Bone 300 [B300]") == nullptr);
+			CHECK(Bones.Find("NPC Bone 001") == nullptr);
+			CHECK(Bones.Find("") == nullptr);
+			CHECK(Bones.Search(Skeleton.Root, "NPC Bone 300 [B300]") == nullptr);
+			CHECK(Bones.Search(Skeleton.Root, "") == nullptr);
+		}
+	}
+
+	//A duplicate name resolves to the first node in pre-order, Find and Search alike, also where breadth first would
+	//have picked a shallower one
+	void TestDuplicates()
+	{
+		SyntheticSkeleton::Skeleton Skeleton = SyntheticSkeleton::Make(300, 3);
+		std::vector<Node*> Order;
+		SyntheticSkeleton::PreOrder(Skeleton.Root, Order);
+
+		//The deepest node in the root's first subtree against the root's last child
+		Node* Deep = Order[1];
+		while (!Deep->Children.empty()) Deep = Deep->Children.front();
+		Node* Shallow = Skeleton.Root->Children.back();
+		CHECK(Deep != Shallow);
+		Deep->Name = "NPC Duplicate";
+		Shallow->Name = "NPC Duplicate";
+
+		//A run of equal names, their hashes tie in the table and have to stay in pre-order
+		for (size_t i = 100; i < 110; i++) {
+			Order[i]->Name = "NPC Twin";
+		}
+
+		//Nameless nodes are indexed under the empty name
+		Order[50]->HasName = false;
+		Order[60]->HasName = false;
+
+		Index Bones;
+		Bones.Build(Skeleton.Root);
+		for (const char* Name : { "NPC Duplicate", "NPC Twin", "" }) {
+			Node* Expected = SyntheticSkeleton::FirstInPreOrder(Skeleton.Root, Name);
+			CHECK(Expected != nullptr);
+			CHECK(Bones.Find(Name) == Expected);
+			CHECK(Bones.Search(Skeleton.Root, Name) == Expected);
+		}
+
+		CHECK(Bones.Find("NPC Duplicate") == Deep);
+		CHECK(SyntheticSkeleton::BreadthFirst(Skeleton.Root, "NPC Duplicate") == Shallow);
+		CHECK(Bones.Find("NPC Twin") == Order[100]);
+		CHECK(Bones.Find("") == Order[50]);
+		CHECK(Bones.Entries()[50].Name != nullptr);
+	}
+
+	void TestMaxNodes()
+	{
+		SyntheticSkeleton::Skeleton Skeleton = SyntheticSkeleton::Make(300, 5);
+		std::vector<Node*> Order;
+		SyntheticSkeleton::PreOrder(Skeleton.Root, Order);
+
+		//The walk stops after MaxNodes, the index keeps the pre-order prefix
+		Index Bones;
+		Bones.Build(Skeleton.Root, 50);
+		CHECK(Bones.Entries().size() == 50);
+		CHECK(Bones.Find(Order[49]->Name) == Order[49]);
+		CHECK(Bones.Find(Order[50]->Name) == nullptr);
+		CHECK(Bones.Search(Skeleton.Root, Order[49]->Name, 50) == Order[49]);
+		CHECK(Bones.Search(Skeleton.Root, Order[50]->Name, 50) == nullptr);
+
+		//A cycle back to the root ends at MaxNodes instead of running forever. Hung off the last node so the first pass
+		//still sees every node, after that the walk goes round again and the first match stays the first pass's
+		Order[299]->Children.push_back(Skeleton.Root);
+		Bones.Build(Skeleton.Root, 1000);
+		CHECK(Bones.Entries().size() == 1000);
+		CHECK(Bones.Entries()[300].Node == Skeleton.Root);
+		CHECK(Bones.Find(Order[299]->Name) == Order[299]);
+		CHECK(Bones.Search(Skeleton.Root, "NPC Missing", 1000) == nullptr);
+		Order[299]->Children.pop_back();
+
+		//Null children are skipped and don't take a slot
+		Skeleton.Root->Children.insert(Skeleton.Root->Children.begin(), nullptr);
+		Bones.Build(Skeleton.Root);
+		CHECK(Bones.Entries().size() == 300);
+		CHECK(Bones.Find(Order[299]->Name) == Order[299]);
+	}
+
+	//The buffers carry over between builds, nothing of the previous skeleton may leak into the next
+	void TestReuse()
+	{
+		SyntheticSkeleton::Skeleton Large = SyntheticSkeleton::Make(300, 7);
+		SyntheticSkeleton::Skeleton Small = SyntheticSkeleton::Make(20, 8);
+
+		Index Bones;
+		Bones.Build(Large.Root);
+		Bones.Build(Small.Root);
+		CHECK(Bones.Entries().size() == 20);
+		CHECK(Bones.Find(Small.Nodes[19].Name) == &Small.Nodes[19]);
+		CHECK(Bones.Find(Large.Nodes[250].Name) == nullptr);
+
+		//Searching another tree leaves the built index alone
+		CHECK(Bones.Search(Large.Root, Large.Nodes[250].Name) == &Large.Nodes[250]);
+		CHECK(Bones.Find(Small.Nodes[5].Name) == &Small.Nodes[5]);
+
+		Bones.Clear();
+		CHECK(Bones.Empty());
+		CHECK(Bones.Find(Small.Nodes[5].Name) == nullptr);
+
+		Bones.Build(nullptr);
+		CHECK(Bones.Empty());
+		CHECK(Bones.Search(nullptr, "NPC Bone 000 [B000]") == nullptr);
+	}
+}
+
+int main()
+{
+	TestBuild();
+	TestDuplicates();
+	TestMaxNodes();
+	TestReuse();
+	return Check::Finish("SkeletonIndexTests");
+}
@@ -0,0 +1,204 @@
+#include "Bench.h"
+#include "Check.h"
+#include "SlotMap.h"
+
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+//The controller registry before and after the slot map. A frame walks every controller and does a little work on its data,
+//the old registry also looked every controller up again by pointer (and took the read lock again) like CharacterControllerUpdate did
+namespace
+{
+	struct FakeController
+	{
+		uint32_t Id;
+	};
+
+	//Roughly the size of the real ControllerData's hot part
+	struct ControllerData
+	{
+		explicit ControllerData(FakeController* Controller) :
+			CharController(Controller) {}
+
+		FakeController* CharController;
+		float ActorScale = 1.f;
+		float Padding[62]{};
+		uint8_t Dirty = 0;
+	};
+
+	void Touch(ControllerData& Data)
+	{
+		Data.ActorScale += 0.001f;
+		Data.Dirty ^= 1;
+	}
+
+	class MapRegistry
+	{
+	public:
+		void Add(FakeController* Controller) { Map.emplace(Controller, std::make_shared<ControllerData>(Controller)); }
+		void Remove(FakeController* Controller) { Map.erase(Controller); }
+
+		std::shared_ptr<ControllerData> Get(FakeController* Controller)
+		{
+			std::shared_lock<std::shared_mutex> Locker(Lock);
+			if (auto Search = Map.find(Controller); Search != Map.end()) return Search->second;
+			return nullptr;
+		}
+
+		void ForEach(std::function<void(std::shared_ptr<ControllerData>)> Fn)
+		{
+			std::shared_lock<std::shared_mutex> Locker(Lock);
+			for (auto& Entry : Map) {
+				Fn(Entry.second);
+			}
+		}
+
+		void Frame()
+		{
+			ForEach([this](std::shared_ptr<ControllerData> Entry) {
+				if (std::shared_ptr<ControllerData> Data = Get(Entry->CharController)) Touch(*Data);
+			});
+		}
+
+	private:
+		std::shared_mutex Lock;
+		std::unordered_map<FakeController*, std::shared_ptr<ControllerData>> Map;
+	};
+
+	class SlotRegistry
+	{
+	public:
+		void Add(FakeController* Controller) { Handles.emplace(Controller, Controllers.Emplace(Controller)); }
+
+		void Remove(FakeController* Controller)
+		{
+			if (auto Search = Handles.find(Controller); Search != Handles.end()) {
+				Controllers.Erase(Search->second);
+				Handles.erase(Search);
+			}
+		}
+
+		ControllerData* Get(FakeController* Controller)
+		{
+			if (auto Search = Handles.find(Controller); Search != Handles.end()) return Controllers.Get(Search->second);
+			return nullptr;
+		}
+
+		void Frame()
+		{
+			std::shared_lock<std::shared_mutex> Locker(Lock);
+			for (ControllerData& Data : Controllers) {
+				Touch(Data);
+			}
+		}
+
+		SlotMap<ControllerData> Controllers;
+
+	private:
+		std::shared_mutex Lock;
+		std::unordered_map<FakeController*, SlotMap<ControllerData>::Handle> Handles;
+	};
+
+	void TestHandles()
+	{
+		SlotMap<int> Map;
+		const auto A = Map.Emplace(1);
+		const auto B = Map.Emplace(2);
+		const auto C = Map.Emplace(3);
+
+		CHECK(Map.Size() == 3);
+		CHECK(Map.Erase(A));
+		CHECK(!Map.Contains(A));
+		CHECK(Map.Get(A) == nullptr);
+		CHECK(!Map.Erase(A));
+
+		//The last value moved into the hole, handles to it still work
+		CHECK(Map.Get(C) && *Map.Get(C) == 3);
+		CHECK(Map.Get(B) && *Map.Get(B) == 2);
+		CHECK(Map[0] == 3);
+		CHECK(Map.GetHandle(0) == C);
+
+		//Reusing the slot must not revive the stale handle
+		const auto D = Map.Emplace(4);
+		CHECK(D.Index == A.Index);
+		CHECK(D.Generation != A.Generation);
+		CHECK(Map.Get(A) == nullptr);
+		CHECK(Map.Get(D) && *Map.Get(D) == 4);
+
+		int Sum = 0;
+		for (int Value : Map) Sum += Value;
+		CHECK(Sum == 9);
+	}
+
+	void TestRegistriesAgree(std::vector<std::unique_ptr<FakeController>>& Keys)
+	{
+		MapRegistry Old;
+		SlotRegistry New;
+		for (auto& Key : Keys) {
+			Old.Add(Key.get());
+			New.Add(Key.get());
+		}
+
+		//Churn like actors loading and unloading
+		for (size_t i = 0; i < Keys.size(); i += 3) {
+			Old.Remove(Keys[i].get());
+			New.Remove(Keys[i].get());
+		}
+
+		Old.Frame();
+		New.Frame();
+
+		size_t Count = 0;
+		for (auto& Key : Keys) {
+			const std::shared_ptr<ControllerData> Expected = Old.Get(Key.get());
+			const ControllerData* Actual = New.Get(Key.get());
+			CHECK((Expected == nullptr) == (Actual == nullptr));
+			if (Expected && Actual) {
+				CHECK(Actual->CharController == Key.get());
+				CHECK(Actual->ActorScale == Expected->ActorScale);
+				Count++;
+			}
+		}
+		CHECK(Count == New.Controllers.Size());
+	}
+}
+
+int main(int ArgCount, char** Args)
+{
+	const bool Quick = Bench::IsQuick(ArgCount, Args);
+
+	TestHandles();
+
+	for (size_t Count : { 10, 100, 1000 }) {
+		std::vector<std::unique_ptr<FakeController>> Keys;
+		for (size_t i = 0; i < Count; i++) {
+			Keys.push_back(std::make_unique<FakeController>(FakeController{ static_cast<uint32_t>(i) }));
+		}
+
+		TestRegistriesAgree(Keys);
+
+		MapRegistry Old;
+		SlotRegistry New;
+		for (auto& Key : Keys) {
+			Old.Add(Key.get());
+			New.Add(Key.get());
+		}
+
+		const size_t Frames = Quick ? 4 : std::max<size_t>(200000 / Count, 100);
+		const double OldFrame = Bench::Measure(Frames, [&](size_t) { Old.Frame(); });
+		const double NewFrame = Bench::Measure(Frames, [&](size_t) { New.Frame(); });
+
+		//Single lookups by controller, what the hooks and api calls do
+		const size_t Lookups = Quick ? 16 : 1000000;
+		const double OldLookup = Bench::Measure(Lookups, [&](size_t i) { Bench::Consume(Old.Get(Keys[(i * 7919) % Count].get())->ActorScale); });
+		const double NewLookup = Bench::Measure(Lookups, [&](size_t i) { Bench::Consume(New.Get(Keys[(i * 7919) % Count].get())->ActorScale); });
+
+		std::printf("%5zu controllers: frame map %9.1fns slot map %9.1fns (%.1fx) | lookup map %5.1fns slot map %5.1fns\n",
+			Count, OldFrame, NewFrame, OldFrame / NewFrame, OldLookup, NewLookup);
+	}
+
+	return Check::Finish("SlotMapBench");
+}
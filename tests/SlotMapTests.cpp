@@ -0,0 +1,128 @@
+#include "Check.h"
+#include "SlotMap.h"
+
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+//Handles against the values they were made for, through erases, slot reuse and clears. A stale handle must never find a value
+namespace
+{
+	using Map = SlotMap<uint32_t>;
+
+	//Erasing swaps the last value into the hole, every other handle still finds its own value
+	void TestErase()
+	{
+		Map Values;
+		std::vector<Map::Handle> Handles;
+		for (uint32_t i = 0; i < 8; i++) {
+			Handles.push_back(Values.Emplace(i));
+		}
+
+		CHECK(Values.Erase(Handles[2]));
+		CHECK(!Values.Erase(Handles[2]));
+		CHECK(!Values.Contains(Handles[2]) && Values.Get(Handles[2]) == nullptr);
+		CHECK(Values.Size() == 7);
+
+		for (uint32_t i = 0; i < 8; i++) {
+			if (i == 2) continue;
+			const uint32_t* Value = Values.Get(Handles[i]);
+			CHECK(Value && *Value == i);
+		}
+
+		//The freed slot is reused under a new generation, the old handle stays stale
+		const Map::Handle Reused = Values.Emplace(100u);
+		CHECK(Reused.Index == Handles[2].Index && Reused.Generation != Handles[2].Generation);
+		CHECK(Values.Get(Handles[2]) == nullptr);
+		CHECK(Values.Get(Reused) && *Values.Get(Reused) == 100);
+
+		for (size_t i = 0; i < Values.Size(); i++) {
+			CHECK(Values.Get(Values.GetHandle(i)) == &Values[i]);
+		}
+	}
+
+	//Clear frees every slot with a generation bump, handles from before it stay stale even once their slots are reused
+	void TestClear()
+	{
+		Map Values;
+		std::vector<Map::Handle> Before;
+		for (uint32_t i = 0; i < 16; i++) {
+			Before.push_back(Values.Emplace(i));
+		}
+		Values.Erase(Before[5]);
+
+		Values.Clear();
+		CHECK(Values.Empty());
+		for (const Map::Handle& Stale : Before) {
+			CHECK(!Values.Contains(Stale));
+		}
+
+		std::vector<Map::Handle> After;
+		for (uint32_t i = 0; i < 32; i++) {
+			After.push_back(Values.Emplace(1000 + i));
+		}
+		for (const Map::Handle& Stale : Before) {
+			CHECK(Values.Get(Stale) == nullptr);
+		}
+		for (uint32_t i = 0; i < 32; i++) {
+			const uint32_t* Value = Values.Get(After[i]);
+			CHECK(Value && *Value == 1000 + i);
+		}
+
+		//The slots are kept, the first 16 values went back into them
+		uint32_t Reused = 0;
+		for (const Map::Handle& Fresh : After) {
+			Reused += Fresh.Index < 16;
+		}
+		CHECK(Reused == 16);
+	}
+
+	//Random emplaces, erases and the odd clear against a plain map of every handle ever made
+	void TestRandom()
+	{
+		std::mt19937 Random(7);
+		Map Values;
+		std::vector<Map::Handle> Live;
+		std::vector<Map::Handle> Dead;
+		std::unordered_map<uint64_t, uint32_t> Expected;
+		const auto KeyOf = [](Map::Handle Of) { return (static_cast<uint64_t>(Of.Index) << 32) | Of.Generation; };
+
+		uint32_t Next = 0;
+		for (int Step = 0; Step < 20000; Step++) {
+			const int Roll = std::uniform_int_distribution<int>(0, 99)(Random);
+			if (Roll < 55 || Live.empty()) {
+				const Map::Handle Added = Values.Emplace(Next);
+				CHECK(!Expected.contains(KeyOf(Added)));
+				Expected[KeyOf(Added)] = Next++;
+				Live.push_back(Added);
+			} else if (Roll < 99) {
+				const size_t Pick = std::uniform_int_distribution<size_t>(0, Live.size() - 1)(Random);
+				CHECK(Values.Erase(Live[Pick]));
+				Dead.push_back(Live[Pick]);
+				Live[Pick] = Live.back();
+				Live.pop_back();
+			} else {
+				Values.Clear();
+				Dead.insert(Dead.end(), Live.begin(), Live.end());
+				Live.clear();
+			}
+		}
+
+		CHECK(Values.Size() == Live.size());
+		for (const Map::Handle& Handle : Live) {
+			const uint32_t* Value = Values.Get(Handle);
+			CHECK(Value && *Value == Expected[KeyOf(Handle)]);
+		}
+		for (const Map::Handle& Handle : Dead) {
+			CHECK(!Values.Contains(Handle));
+		}
+	}
+}
+
+int main()
+{
+	TestErase();
+	TestClear();
+	TestRandom();
+	return Check::Finish("SlotMapTests");
+}
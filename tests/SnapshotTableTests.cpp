@@ -0,0 +1,190 @@
+#include "Check.h"
+#include "SnapshotTable.h"
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+//One writer publishing as fast as it can while readers look entries up, every entry a reader gets has to be whole and from
+//the frame Find reports. Entries are wider than a cache line so a torn copy shows up as words from different frames
+namespace
+{
+	constexpr size_t Capacity = 512;
+	constexpr uint32_t Keys = 600;  //More than fit, the largest keys get dropped
+	constexpr uint32_t Readers = 4;
+	constexpr uint64_t Frames = 10000;
+
+	struct Entry
+	{
+		uint32_t Key;
+		uint32_t Padding;
+		uint64_t Frame;
+		uint64_t Words[14];  //Every word derived from the key and the frame
+	};
+
+	uint64_t WordFor(uint32_t Key, uint64_t Frame, size_t Index)
+	{
+		return (Frame * 0x9e3779b97f4a7c15ull) ^ (static_cast<uint64_t>(Key) << 20) ^ Index;
+	}
+
+	//Every other key is only published on even frames so the count and the positions keep changing
+	bool Published(uint32_t Key, uint64_t Frame)
+	{
+		return Key % 2 == 0 || Frame % 2 == 0;
+	}
+
+	//Whether Key made it into Frame's publish, the Capacity smallest published keys do
+	bool Fits(uint32_t Key, uint64_t Frame)
+	{
+		uint32_t Smaller = 0;
+		for (uint32_t Other = 0; Other < Key; Other++) {
+			Smaller += Published(Other, Frame);
+		}
+		return Smaller < Capacity;
+	}
+
+	void Stage(SnapshotTable<Entry, Capacity>& Table, uint64_t Frame, std::mt19937& Random)
+	{
+		std::vector<Entry>& Staged = Table.Stage();
+		for (uint32_t Key = 0; Key < Keys; Key++) {
+			if (!Published(Key, Frame)) continue;
+
+			Entry& Added = Staged.emplace_back();
+			Added.Key = Key;
+			Added.Padding = 0;
+			Added.Frame = Frame;
+			for (size_t i = 0; i < 14; i++) {
+				Added.Words[i] = WordFor(Key, Frame, i);
+			}
+		}
+
+		//Publish sorts, the staged order must not matter
+		std::shuffle(Staged.begin(), Staged.end(), Random);
+	}
+
+	struct ReaderStats
+	{
+		uint64_t Lookups = 0;
+		uint64_t Hits = 0;
+		uint64_t Torn = 0;        //Words from another frame or key
+		uint64_t WrongHit = 0;    //Found or missed against what the reported frame published
+		uint64_t Backwards = 0;   //Reported frame went back
+	};
+
+	void TestTornReads()
+	{
+		static SnapshotTable<Entry, Capacity> Table;
+		std::atomic<bool> Done{ false };
+		std::vector<ReaderStats> Stats(Readers);
+
+		//Fits() is a linear count, worked out once per key for both kinds of frame
+		std::vector<bool> FitsEven(Keys), FitsOdd(Keys);
+		for (uint32_t Key = 0; Key < Keys; Key++) {
+			FitsEven[Key] = Fits(Key, 0);
+			FitsOdd[Key] = Fits(Key, 1);
+		}
+
+		std::vector<std::thread> Threads;
+		for (uint32_t Reader = 0; Reader < Readers; Reader++) {
+			Threads.emplace_back([&, Reader]() {
+				std::mt19937 Random(Reader + 1);
+				std::uniform_int_distribution<uint32_t> Pick(0, Keys - 1);
+				ReaderStats& Mine = Stats[Reader];
+				uint64_t LastFrame = 0;
+
+				while (!Done.load(std::memory_order_acquire)) {
+					const uint32_t Key = Pick(Random);
+					Entry Found{};
+					uint64_t Frame = 0;
+					const bool Hit = Table.Find(Key, Found, Frame);
+					Mine.Lookups++;
+
+					Mine.Backwards += Frame < LastFrame;
+					LastFrame = Frame;
+
+					//Nothing published yet
+					if (Frame == 0) continue;
+
+					const bool Expected = Published(Key, Frame) && (Frame % 2 ? FitsOdd[Key] : FitsEven[Key]);
+					Mine.WrongHit += Hit != Expected;
+					if (!Hit) continue;
+
+					Mine.Hits++;
+					bool Whole = Found.Key == Key && Found.Frame == Frame;
+					for (size_t i = 0; i < 14; i++) {
+						Whole = Whole && Found.Words[i] == WordFor(Key, Frame, i);
+					}
+					Mine.Torn += !Whole;
+				}
+			});
+		}
+
+		std::mt19937 Random(42);
+		for (uint64_t Frame = 1; Frame <= Frames; Frame++) {
+			Stage(Table, Frame, Random);
+			Table.Publish(Frame);
+			CHECK(Table.DroppedCount() == (Frame % 2 ? 0 : Keys - Capacity));
+		}
+
+		Done.store(true, std::memory_order_release);
+		for (std::thread& Thread : Threads) {
+			Thread.join();
+		}
+
+		ReaderStats Total{};
+		for (const ReaderStats& Each : Stats) {
+			Total.Lookups += Each.Lookups;
+			Total.Hits += Each.Hits;
+			Total.Torn += Each.Torn;
+			Total.WrongHit += Each.WrongHit;
+			Total.Backwards += Each.Backwards;
+		}
+
+		CHECK(Total.Torn == 0);
+		CHECK(Total.WrongHit == 0);
+		CHECK(Total.Backwards == 0);
+		CHECK(Total.Hits > 0);
+		std::printf("%llu frames, %llu lookups, %llu hits, %llu torn\n", static_cast<unsigned long long>(Frames), static_cast<unsigned long long>(Total.Lookups),
+			static_cast<unsigned long long>(Total.Hits), static_cast<unsigned long long>(Total.Torn));
+	}
+
+	//Single threaded: nothing before the first publish, then exactly the last publish's entries
+	void TestFind()
+	{
+		static SnapshotTable<Entry, Capacity> Table;
+		Entry Found{};
+		uint64_t Frame = 99;
+		CHECK(!Table.Find(0, Found, Frame));
+		CHECK(Frame == 0);
+
+		std::mt19937 Random(7);
+		//Only the smallest keys fit, the rest are counted as dropped
+		Stage(Table, 2, Random);
+		Table.Publish(2);
+		CHECK(Table.DroppedCount() == Keys - Capacity);
+		CHECK(Table.Find(1, Found, Frame) && Found.Key == 1 && Frame == 2);
+		CHECK(Table.Find(Capacity - 1, Found, Frame));
+		CHECK(!Table.Find(Capacity, Found, Frame));
+		CHECK(!Table.Find(Keys, Found, Frame));
+
+		Stage(Table, 3, Random);
+		Table.Publish(3);
+		CHECK(Table.DroppedCount() == 0);
+		CHECK(!Table.Find(1, Found, Frame) && Frame == 3);
+		CHECK(Table.Find(2, Found, Frame) && Found.Frame == 3);
+		CHECK(Table.Find(Keys - 2, Found, Frame));
+
+		//An empty publish replaces everything
+		Table.Stage();
+		Table.Publish(4);
+		CHECK(!Table.Find(2, Found, Frame) && Frame == 4);
+	}
+}
+
+int main()
+{
+	TestFind();
+	TestTornReads();
+	return Check::Finish("SnapshotTableTests");
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "ControllerHull.h"
+
+#include <cmath>
+#include <vector>
+
+//Controller shaped hulls for the tests: two rings stacked on top of each other, closed by an apex above and below unless the
+//layout has none, every vertex placed at the index the layout gives it
+namespace SyntheticHull
+{
+	using ControllerHull::Vector;
+
+	struct Shape
+	{
+		float Radius = 0.25f;
+		float BottomZ = 0.2f;
+		float TopZ = 1.4f;
+		float BottomApexZ = 0.f;
+		float TopApexZ = 1.6f;
+		float AngleOffset = 0.f;  //Rotates both rings, radians
+		float OffsetX = 0.f;      //Moves the whole hull
+		float OffsetY = 0.f;
+	};
+
+	inline std::vector<Vector> Make(const ControllerHull::Topology& Layout, const Shape& Params = {})
+	{
+		constexpr float Pi = 3.14159265f;
+		std::vector<Vector> Verts(Layout.VertexCount, Vector{ 0.f, 0.f, 0.f, 0.f });
+
+		for (size_t i = 0; i < Layout.RingSize; i++) {
+			const float Angle = Params.AngleOffset + 2.f * Pi * static_cast<float>(i) / static_cast<float>(Layout.RingSize);
+			const float X = Params.OffsetX + std::cos(Angle) * Params.Radius;
+			const float Y = Params.OffsetY + std::sin(Angle) * Params.Radius;
+			Verts[Layout.BottomRing[i]] = { X, Y, Params.BottomZ, 0.f };
+			Verts[Layout.TopRing[i]] = { X, Y, Params.TopZ, 0.f };
+		}
+
+		if (Layout.BottomApex != ControllerHull::NoApex) Verts[Layout.BottomApex] = { Params.OffsetX, Params.OffsetY, Params.BottomApexZ, 0.f };
+		if (Layout.TopApex != ControllerHull::NoApex) Verts[Layout.TopApex] = { Params.OffsetX, Params.OffsetY, Params.TopApexZ, 0.f };
+		return Verts;
+	}
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "ShapeVisitor.h"
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <initializer_list>
+#include <vector>
+
+//Shape trees for the ShapeVisitor tests, one node type standing in for havok's capsules, convex shapes, list shapes and
+//MOPP trees. Container children go through the per-level child buffer the way MOPP children are built into an
+//hkpShapeBuffer, the buffer remembers which child it holds so a walk that reuses it too early can be caught
+namespace SyntheticShapes
+{
+	using ShapeVisitor::Kind;
+
+	struct Shape
+	{
+		Kind Type = Kind::kOther;
+		int Id = 0;
+		std::vector<const Shape*> Children;
+	};
+
+	//Same size as hkpShapeBuffer
+	struct ChildBuffer
+	{
+		alignas(16) std::array<uint8_t, 512> Storage;
+		const Shape* Holds = nullptr;
+		uint32_t Writes = 0;
+	};
+
+	//Set whenever a container's child buffer no longer holds the child its subtree is being walked for
+	inline uint32_t Clobbered = 0;
+
+	struct Traits
+	{
+		using Shape = SyntheticShapes::Shape;
+		using Capsule = SyntheticShapes::Shape;
+		using Convex = SyntheticShapes::Shape;
+		using ChildBuffer = SyntheticShapes::ChildBuffer;
+
+		static Kind TypeOf(const Shape* Node) { return Node->Type; }
+		static Capsule* AsCapsule(const Shape* Node) { return const_cast<Shape*>(Node); }
+		static Convex* AsConvex(const Shape* Node) { return const_cast<Shape*>(Node); }
+
+		template <class Fn>
+		static void ForEachListChild(const Shape* Node, Fn&& Callback)
+		{
+			for (const Shape* Child : Node->Children) {
+				if (Child) Callback(Child);
+			}
+		}
+
+		template <class Fn>
+		static void ForEachContainerChild(const Shape* Node, ChildBuffer& Buffer, Fn&& Callback)
+		{
+			for (const Shape* Child : Node->Children) {
+				Buffer.Holds = Child;
+				Buffer.Writes++;
+				Callback(Child);
+				Clobbered += Buffer.Holds != Child;
+			}
+		}
+	};
+
+	//Owns the nodes, pointers into it stay valid as it grows
+	class Tree
+	{
+	public:
+		const Shape* Add(Kind Type, std::initializer_list<const Shape*> Children = {})
+		{
+			Shape& Node = Nodes.emplace_back();
+			Node.Type = Type;
+			Node.Id = static_cast<int>(Nodes.size());
+			Node.Children = Children;
+			return &Node;
+		}
+
+		const Shape* Capsule() { return Add(Kind::kCapsule); }
+		const Shape* Convex() { return Add(Kind::kConvex); }
+		const Shape* List(std::initializer_list<const Shape*> Children) { return Add(Kind::kList, Children); }
+		const Shape* Container(std::initializer_list<const Shape*> Children) { return Add(Kind::kContainer, Children); }
+
+	private:
+		std::deque<Shape> Nodes;
+	};
+
+	//What a controller usually has: the convex hull and a couple of capsules in a list shape
+	inline const Shape* MakeController(Tree& Shapes)
+	{
+		return Shapes.List({ Shapes.Convex(), Shapes.Capsule(), Shapes.Capsule() });
+	}
+
+	//A bigger one with MOPP trees two levels deep, like some creatures' controllers
+	inline const Shape* MakeCreature(Tree& Shapes)
+	{
+		return Shapes.List({ Shapes.Convex(),
+			Shapes.Container({ Shapes.Capsule(), Shapes.Add(Kind::kOther), Shapes.List({ Shapes.Capsule(), Shapes.Capsule() }) }),
+			Shapes.Container({ Shapes.Container({ Shapes.Capsule(), Shapes.Capsule() }), Shapes.Capsule() }), Shapes.Capsule() });
+	}
+
+	//The recursive walk GetShapes and GetCapsules had before the visitor, with a fresh buffer on the stack for every container
+	//like the hkpShapeBuffer it declared. Keeps the first convex shape like the visitor, the old walk kept the last but
+	//controllers only have the one
+	inline void Reference(const Shape* Node, std::vector<Shape*>& Capsules, Shape*& Convex, size_t MaxDepth = SIZE_MAX, size_t Depth = 0)
+	{
+		if (!Node || Depth >= MaxDepth) return;
+
+		switch (Node->Type) {
+			case Kind::kCapsule:
+				Capsules.push_back(const_cast<Shape*>(Node));
+				break;
+
+			case Kind::kConvex:
+				if (!Convex) Convex = const_cast<Shape*>(Node);
+				break;
+
+			case Kind::kList:
+				for (const Shape* Child : Node->Children) {
+					Reference(Child, Capsules, Convex, MaxDepth, Depth + 1);
+				}
+				break;
+
+			case Kind::kContainer: {
+				ChildBuffer Buffer{};
+				Traits::ForEachContainerChild(Node, Buffer, [&](const Shape* Child) { Reference(Child, Capsules, Convex, MaxDepth, Depth + 1); });
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+}
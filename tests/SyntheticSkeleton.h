@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//Node trees shaped like an actor skeleton for the SkeletonIndex tests: a long spine with limbs and finger chains hanging off
+//it, plus the reference lookups the index replaced and has to agree with
+namespace SyntheticSkeleton
+{
+	struct Node
+	{
+		std::string Name;
+		bool HasName = true;  //NiAVObjects can come without a name
+		std::vector<Node*> Children;
+	};
+
+	struct Traits
+	{
+		static const char* Name(Node* Node) { return Node->HasName ? Node->Name.c_str() : nullptr; }
+
+		template <class Fn>
+		static void ForEachChild(Node* Node, Fn&& Callback)
+		{
+			for (auto* Child : Node->Children) {
+				Callback(Child);
+			}
+		}
+	};
+
+	//Move only, a copy's children would still point into the original
+	struct Skeleton
+	{
+		Skeleton() = default;
+		Skeleton(Skeleton&&) = default;
+		Skeleton(const Skeleton&) = delete;
+		Skeleton& operator=(Skeleton&&) = default;
+		Skeleton& operator=(const Skeleton&) = delete;
+
+		std::deque<Node> Nodes;  //Creation order, a deque so the pointers stay put
+		Node* Root = nullptr;
+	};
+
+	//Every node hangs off one of the last few created, which gives chains a few dozen deep with branches along them.
+	//Names are unique and look like the game's, "NPC Bone 042 [B042]"
+	inline Skeleton Make(size_t Count, uint32_t Seed = 1)
+	{
+		std::mt19937 Random(Seed);
+		Skeleton Out;
+		for (size_t i = 0; i < Count; i++) {
+			char Name[64];
+			std::snprintf(Name, sizeof(Name), "NPC Bone %03zu [B%03zu]", i, i);
+			Node& Created = Out.Nodes.emplace_back();
+			Created.Name = Name;
+
+			if (i > 0) {
+				std::uniform_int_distribution<size_t> Parent(i > 8 ? i - 8 : 0, i - 1);
+				Out.Nodes[Parent(Random)].Children.push_back(&Created);
+			}
+		}
+		Out.Root = Count ? &Out.Nodes[0] : nullptr;
+		return Out;
+	}
+
+	//Plain recursive pre-order, the order SkeletonIndex promises
+	inline void PreOrder(Node* Current, std::vector<Node*>& Out)
+	{
+		if (!Current) return;
+		Out.push_back(Current);
+		for (Node* Child : Current->Children) {
+			PreOrder(Child, Out);
+		}
+	}
+
+	inline Node* FirstInPreOrder(Node* Root, std::string_view Name)
+	{
+		std::vector<Node*> Order;
+		PreOrder(Root, Order);
+		for (Node* Current : Order) {
+			if (std::string_view(Traits::Name(Current) ? Traits::Name(Current) : "") == Name) return Current;
+		}
+		return nullptr;
+	}
+
+	//The lookup Utils::FindBoneNode used before the index, a deque breadth first walk comparing every name through c_str()
+	inline Node* BreadthFirst(Node* Root, std::string_view Name)
+	{
+		std::deque<Node*> Queue;
+		Queue.push_back(Root);
+		int RecursionCheck = 512;
+
+		while (!Queue.empty()) {
+			Node* Current = Queue.front();
+			Queue.pop_front();
+			if (RecursionCheck-- <= 0) return nullptr;
+
+			if (Current) {
+				for (Node* Child : Current->Children) {
+					Queue.push_back(Child);
+				}
+				if (Current->HasName && Current->Name.c_str() == Name) return Current;
+			}
+		}
+		return nullptr;
+	}
+}
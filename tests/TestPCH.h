@@ -0,0 +1,14 @@
+#pragma once
+
+//Stands in for the plugin's PCH.h, the few translation units the tests compile only need the logger from it.
+//Nothing gets logged, the tests print their own output
+namespace logger
+{
+	template <class... Args>
+	void info(const char*, Args&&...)
+	{}
+
+	template <class... Args>
+	void warn(const char*, Args&&...)
+	{}
+}
@@ -0,0 +1,138 @@
+#include "Bench.h"
+#include "Check.h"
+#include "ControllerHull.h"
+#include "RingKernel.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+//The compute phase of 500 synthetic actors, spread over 0 to N workers the way Update does it.
+//Every actor does what ComputeConvexShapeSimple does to a Standard18 hull: copy the original vertices, move the top apex
+//and rescale both rings. The results have to match a serial run no matter how many workers took part
+namespace
+{
+	constexpr size_t Actors = 500;
+
+	struct SyntheticActor
+	{
+		float OriginalVerts[18][4];
+		float Verts[18][4];
+		float Scale;
+		float Checksum;
+	};
+
+	void MakeHull(SyntheticActor& Actor, float Scale)
+	{
+		const ControllerHull::Topology& Layout = ControllerHull::Standard18;
+		constexpr float Pi = 3.14159265f;
+
+		for (size_t i = 0; i < Layout.RingSize; i++) {
+			const float Angle = 2.f * Pi * static_cast<float>(i) / static_cast<float>(Layout.RingSize);
+			const float X = std::cos(Angle) * 0.25f;
+			const float Y = std::sin(Angle) * 0.25f;
+			float* Bottom = Actor.OriginalVerts[Layout.BottomRing[i]];
+			float* Top = Actor.OriginalVerts[Layout.TopRing[i]];
+			Bottom[0] = X, Bottom[1] = Y, Bottom[2] = 0.2f, Bottom[3] = 0.f;
+			Top[0] = X, Top[1] = Y, Top[2] = 1.4f, Top[3] = 0.f;
+		}
+
+		float* TopApex = Actor.OriginalVerts[Layout.TopApex];
+		float* BottomApex = Actor.OriginalVerts[Layout.BottomApex];
+		TopApex[0] = 0.f, TopApex[1] = 0.f, TopApex[2] = 1.6f, TopApex[3] = 0.f;
+		BottomApex[0] = 0.f, BottomApex[1] = 0.f, BottomApex[2] = 0.f, BottomApex[3] = 0.f;
+
+		Actor.Scale = Scale;
+		Actor.Checksum = 0.f;
+	}
+
+	void Compute(SyntheticActor& Actor)
+	{
+		const ControllerHull::Topology& Layout = ControllerHull::Standard18;
+		std::copy(&Actor.OriginalVerts[0][0], &Actor.OriginalVerts[0][0] + 18 * 4, &Actor.Verts[0][0]);
+
+		const float TopZ = Actor.OriginalVerts[Layout.TopApex][2];
+		const float NewTopZ = TopZ * 2.f * Actor.Scale;
+		Actor.Verts[Layout.TopApex][2] = NewTopZ;
+
+		RingKernel::Params Ring{};
+		Ring.Radius = 0.25f * Actor.Scale;
+		Ring.ZOffset = NewTopZ - TopZ;
+		RingKernel::Apply(Actor.Verts, Layout.TopRing.data(), Layout.RingSize, Ring);
+
+		Ring.ZOffset = 0.f;
+		Ring.ClampToFloor = true;
+		Ring.FloorZ = Actor.Verts[Layout.BottomApex][2];
+		Ring.FloorEpsilon = 0.01f;
+		RingKernel::Apply(Actor.Verts, Layout.BottomRing.data(), Layout.RingSize, Ring);
+
+		float Sum = 0.f;
+		for (const auto& Vertex : Actor.Verts) {
+			Sum += Vertex[0] + Vertex[1] + Vertex[2];
+		}
+		Actor.Checksum = Sum;
+	}
+}
+
+int main(int ArgCount, char** Args)
+{
+	const bool Quick = Bench::IsQuick(ArgCount, Args);
+	ThreadPool* Pool = ThreadPool::GetSingleton();
+
+	std::vector<SyntheticActor> Reference(Actors);
+	std::vector<SyntheticActor> Parallel(Actors);
+	for (size_t i = 0; i < Actors; i++) {
+		MakeHull(Reference[i], 0.5f + static_cast<float>(i % 40) * 0.1f);
+		MakeHull(Parallel[i], 0.5f + static_cast<float>(i % 40) * 0.1f);
+		Compute(Reference[i]);
+	}
+
+	//Never fewer than 3 workers so the stealing gets exercised even on small machines
+	const uint32_t MaxWorkers = std::max(std::thread::hardware_concurrency(), 4u) - 1;
+	const size_t Frames = Quick ? 3 : 2000;
+	double Serial = 0.;
+
+	for (uint32_t Workers = 0; Workers <= MaxWorkers; Workers++) {
+		if (Workers == 0) {
+			Pool->Stop();
+		} else {
+			Pool->Resize(Workers);
+		}
+
+		//Same grain as Update
+		const double Frame = Bench::Measure(Frames, [&](size_t) {
+			Pool->ParallelFor(Parallel.size(), 2, [&Parallel](size_t Index) {
+				Compute(Parallel[Index]);
+			});
+		});
+
+		bool Matches = true;
+		for (size_t i = 0; i < Actors; i++) {
+			Matches = Matches && std::memcmp(Parallel[i].Verts, Reference[i].Verts, sizeof(Reference[i].Verts)) == 0 && Parallel[i].Checksum == Reference[i].Checksum;
+			Parallel[i].Checksum = 0.f;
+		}
+		CHECK(Matches);
+
+		if (Workers == 0) Serial = Frame;
+		std::printf("%u thread(s): %8.1fus per frame of %zu actors, %.2fx\n", Workers + 1, Frame / 1000., Actors, Serial / Frame);
+	}
+
+	//Every index runs exactly once, also with odd counts and grains
+	for (size_t Count : { 1, 7, 64, 501 }) {
+		for (size_t Grain : { 1, 3, 16 }) {
+			std::vector<std::atomic<uint32_t>> Hits(Count);
+			Pool->ParallelFor(Count, Grain, [&Hits](size_t Index) { Hits[Index].fetch_add(1, std::memory_order_relaxed); });
+
+			bool Once = true;
+			for (const auto& Hit : Hits) Once = Once && Hit.load() == 1;
+			CHECK(Once);
+		}
+	}
+
+	Pool->Stop();
+	return Check::Finish("ThreadPoolBench");
+}